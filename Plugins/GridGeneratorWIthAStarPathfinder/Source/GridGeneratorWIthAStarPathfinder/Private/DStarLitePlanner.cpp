@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DStarLitePlanner.h"
+#include "Grid.h"
+#include "Misc/ScopeRWLock.h"
+#include "OctileDistance.h"
+
+void FDStarLitePlanner::Initialize(const AGrid& InGrid, int32 InStartCell, int32 InTargetCell)
+{
+	Grid = &InGrid;
+	StartCell = InStartCell;
+	LastStartCell = InStartCell;
+	TargetCell = InTargetCell;
+	KeyModifier = 0;
+	// All cells start unreachable, only the target is known to reach itself, so it's the only inconsistent cell
+	int32 NumCells = Grid->GetNumCells();
+	Cells.Init(FPlannerCell{ Infinity, Infinity }, NumCells);
+	Queue.Initialize(NumCells);
+	Cells[TargetCell].rhs = 0;
+	int32 Key1, Key2;
+	CalculateKey(TargetCell, Key1, Key2);
+	Queue.Add(TargetCell, Key1, Key2);
+}
+
+void FDStarLitePlanner::Reset()
+{
+	Grid = nullptr;
+	Cells.Empty();
+	Queue.Initialize(0);
+	StartCell = INDEX_NONE;
+	TargetCell = INDEX_NONE;
+}
+
+bool FDStarLitePlanner::IsInitialized(int32 NumCells) const
+{
+	return Grid != nullptr && Cells.Num() == NumCells;
+}
+
+int32 FDStarLitePlanner::GetStartCell() const
+{
+	return StartCell;
+}
+
+int32 FDStarLitePlanner::GetTargetCell() const
+{
+	return TargetCell;
+}
+
+void FDStarLitePlanner::SetStartCell(int32 InStartCell)
+{
+	StartCell = InStartCell;
+}
+
+void FDStarLitePlanner::NotifyRegionChanged(FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	if (Grid == nullptr)
+	{
+		return;
+	}
+	// Keys of cells in the queue were calculated from the last start, move it to the current start first so the keys of the updated cells match them
+	KeyModifier += GetDistanceBetweenCells(LastStartCell, StartCell);
+	LastStartCell = StartCell;
+	// Moves into and out of every changed cell changed cost, so the rhs of the changed cells and all their neighbors must be recalculated
+	int32 NumRows = Grid->GetNumCells() / Grid->GridSizeX;
+	for (int32 y = FMath::Max(MinIndex.Y - 1, 0); y <= FMath::Min(MaxIndex.Y + 1, NumRows - 1); y++)
+	{
+		for (int32 x = FMath::Max(MinIndex.X - 1, 0); x <= FMath::Min(MaxIndex.X + 1, Grid->GridSizeX - 1); x++)
+		{
+			UpdateCell(Grid->GetCellIndex(x, y));
+		}
+	}
+}
+
+bool FDStarLitePlanner::Plan(TArray<int32>& OutPath)
+{
+	OutPath.Reset();
+	NumExpanded = 0;
+	if (Grid == nullptr)
+	{
+		return false;
+	}
+	// Hold the Grid cell data lock for reading, so cells aren't rebaked while the tree is repaired
+	FReadScopeLock CellDataLock(Grid->GetCellDataLock());
+	// Adjust the keys for the start moved since the last plan, then repair the tree
+	KeyModifier += GetDistanceBetweenCells(LastStartCell, StartCell);
+	LastStartCell = StartCell;
+	ComputeShortestPath();
+	if (Cells[StartCell].g_cost >= Infinity)
+	{
+		return false;
+	}
+	// Follow the tree from the start, moving each time to the neighbor with the smallest move cost plus g_cost, until the target is reached
+	int32 CurrentCell = StartCell;
+	OutPath.Add(CurrentCell);
+	while (CurrentCell != TargetCell)
+	{
+		int32 BestCell = INDEX_NONE;
+		int32 BestCost = Infinity;
+		Grid->ForEachNeighborCell(CurrentCell, [this, CurrentCell, &BestCell, &BestCost](int32 Neighbor)
+		{
+			int32 Cost = AddCosts(GetMoveCost(CurrentCell, Neighbor), Cells[Neighbor].g_cost);
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestCell = Neighbor;
+			}
+		});
+		// A consistent tree always leads to the target, stop if it doesn't rather than looping
+		if (BestCell == INDEX_NONE || OutPath.Num() > Cells.Num())
+		{
+			OutPath.Reset();
+			return false;
+		}
+		CurrentCell = BestCell;
+		OutPath.Add(CurrentCell);
+	}
+	return true;
+}
+
+int32 FDStarLitePlanner::GetNumExpanded() const
+{
+	return NumExpanded;
+}
+
+void FDStarLitePlanner::ComputeShortestPath()
+{
+	while (!Queue.IsEmpty())
+	{
+		// Stop once the smallest key in the queue isn't smaller than the key of the start cell and the start cell is consistent
+		int32 TopKey1, TopKey2, StartKey1, StartKey2;
+		Queue.GetTopCosts(TopKey1, TopKey2);
+		CalculateKey(StartCell, StartKey1, StartKey2);
+		if (!IsKeyLess(TopKey1, TopKey2, StartKey1, StartKey2) && Cells[StartCell].rhs == Cells[StartCell].g_cost)
+		{
+			break;
+		}
+		int32 CurrentCell = Queue.Top();
+		NumExpanded++;
+		// Key calculated before the start moved is outdated, move the cell with its new key
+		int32 NewKey1, NewKey2;
+		CalculateKey(CurrentCell, NewKey1, NewKey2);
+		if (IsKeyLess(TopKey1, TopKey2, NewKey1, NewKey2))
+		{
+			Queue.Reprioritize(CurrentCell, NewKey1, NewKey2);
+			continue;
+		}
+		FPlannerCell& Current = Cells[CurrentCell];
+		if (Current.g_cost > Current.rhs)
+		{
+			// Overconsistent: the cell got cheaper, settle its cost and let the neighbors use it
+			Current.g_cost = Current.rhs;
+			Queue.Remove(CurrentCell);
+		}
+		else
+		{
+			// Underconsistent: the cell got more expensive, make it unreachable so it and the neighbors that used it are recalculated
+			Current.g_cost = Infinity;
+			UpdateCell(CurrentCell);
+		}
+		Grid->ForEachNeighborCell(CurrentCell, [this](int32 Neighbor)
+		{
+			UpdateCell(Neighbor);
+		});
+	}
+}
+
+void FDStarLitePlanner::UpdateCell(int32 CellIndex)
+{
+	// Recalculate the rhs from the neighbors, the target always reaches itself at no cost
+	FPlannerCell& Cell = Cells[CellIndex];
+	if (CellIndex != TargetCell)
+	{
+		Cell.rhs = CalculateRhs(CellIndex);
+	}
+	// Inconsistent cells are in the queue with their current key, consistent cells aren't in it
+	bool bInQueue = Queue.Contains(CellIndex);
+	if (Cell.g_cost != Cell.rhs)
+	{
+		int32 Key1, Key2;
+		CalculateKey(CellIndex, Key1, Key2);
+		if (bInQueue)
+		{
+			Queue.Reprioritize(CellIndex, Key1, Key2);
+		}
+		else
+		{
+			Queue.Add(CellIndex, Key1, Key2);
+		}
+	}
+	else if (bInQueue)
+	{
+		Queue.Remove(CellIndex);
+	}
+}
+
+int32 FDStarLitePlanner::CalculateRhs(int32 CellIndex)
+{
+	// Smallest cost of moving to a neighbor plus the neighbor cost to the target
+	int32 Rhs = Infinity;
+	Grid->ForEachNeighborCell(CellIndex, [this, CellIndex, &Rhs](int32 Neighbor)
+	{
+		Rhs = FMath::Min(Rhs, AddCosts(GetMoveCost(CellIndex, Neighbor), Cells[Neighbor].g_cost));
+	});
+	return Rhs;
+}
+
+void FDStarLitePlanner::CalculateKey(int32 CellIndex, int32& OutKey1, int32& OutKey2) const
+{
+	const FPlannerCell& Cell = Cells[CellIndex];
+	OutKey2 = FMath::Min(Cell.g_cost, Cell.rhs);
+	OutKey1 = AddCosts(OutKey2, GetDistanceBetweenCells(StartCell, CellIndex) + KeyModifier);
+}
+
+bool FDStarLitePlanner::IsKeyLess(int32 A1, int32 A2, int32 B1, int32 B2)
+{
+	return A1 < B1 || (A1 == B1 && A2 < B2);
+}
+
+int32 FDStarLitePlanner::GetMoveCost(int32 FromCell, int32 ToCell) const
+{
+	// Same moves and cell costs as the pathfinder, a move is blocked if either cell is unwalkable so costs are the same in both directions
+	if (!Grid->IsCellWalkable(FromCell) || !Grid->IsCellWalkable(ToCell))
+	{
+		return Infinity;
+	}
+	return Grid->GetMoveCost(FromCell, ToCell, GetDistanceBetweenCells(FromCell, ToCell));
+}
+
+int32 FDStarLitePlanner::GetDistanceBetweenCells(int32 StartCellIndex, int32 EndCellIndex) const
+{
+	return FOctileDistance::Get(Grid->GetCellX(EndCellIndex) - Grid->GetCellX(StartCellIndex), Grid->GetCellY(EndCellIndex) - Grid->GetCellY(StartCellIndex));
+}
+
+int32 FDStarLitePlanner::AddCosts(int32 A, int32 B)
+{
+	return (A >= Infinity || B >= Infinity) ? Infinity : FMath::Min(A + B, Infinity);
+}
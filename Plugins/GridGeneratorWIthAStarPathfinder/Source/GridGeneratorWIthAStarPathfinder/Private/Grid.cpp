@@ -3,6 +3,43 @@
 
 #include "Grid.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Misc/ScopeRWLock.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Misc/FileHelper.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/MemoryWriter.h"
+#include "Hash/CityHash.h"
+#include "EngineUtils.h"
+#include "PathfindingStats.h"
+
+namespace
+{
+	// Header at the start of a baked grid file, followed by the walkable bits as 32 bit words, the heights and the costs of all cells, each section aligned to 16 bytes
+	// Values are stored little endian, the file is read in place from the mapped memory
+	struct FGridBakeFileHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		int32 GridSizeX;
+		int32 GridSizeY;
+		float NodeRadius;
+		uint32 Padding;
+		uint64 LevelHash;									// Hash of the level and grid settings the cells were baked from
+		uint64 WalkableOffset;								// Offsets of the sections from the start of the file
+		uint64 HeightsOffset;
+		uint64 CostsOffset;
+	};
+
+	constexpr uint32 GridBakeFileMagic = 0x42445247;		// "GRDB"
+	constexpr uint32 GridBakeFileVersion = 1;				// Incremented when the layout of the file changes, files of other versions are rebaked
+	constexpr uint64 GridBakeFileAlignment = 16;
+}
 
 // Sets default values
 AGrid::AGrid()
@@ -19,6 +56,14 @@ AGrid::AGrid()
 	// Create Dynamic material instance from the found material, and set as the material of the mesh component
 	GridMaterial = GridMesh->CreateDynamicMaterialInstance(0, MaterialObject);
 	GridMesh->SetMaterial(0, GridMaterial);
+	// Creating the instanced mesh of the cell view, a plane per cell like the GridNode mesh, without collision or shadows
+	CellInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("Cell Instances"));
+	CellInstances->SetupAttachment(RootComponent);
+	ConstructorHelpers::FObjectFinder<UStaticMesh> PlaneAsset(TEXT("StaticMesh'/Engine/BasicShapes/Plane.Plane'"));
+	CellInstances->SetStaticMesh(PlaneAsset.Object);
+	CellInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CellInstances->SetCastShadow(false);
+	CellViewMaterial = MaterialObject;
 }
 
 void AGrid::OnConstruction(const FTransform& Transform)
@@ -41,95 +86,763 @@ void AGrid::BeginPlay()
 	
 }
 
+void AGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Discard the running bake and wait for its worker task, it traces the world of this grid
+	LatestBakeId++;
+	BakeTask.Wait();
+	UE::Tasks::Wait(TileBakeTasks);
+	TileBakeTasks.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
 void AGrid::CreateGrid()
 {
 	// Calculate the value of GridWorldSize based on GridSizeX and GridSizeY
 	float NodeDiameter = NodeRadius * 2;
 	GridWorldSize.X = GridSizeX * NodeDiameter;
 	GridWorldSize.Y = GridSizeY * NodeDiameter;
-	// Get the bottom left corner locaton of the grid, used to calculate the locations of all other nodes afterwards
-	FVector BottomLeftLocation = GetActorLocation() + FVector(-1.f * GridWorldSize.X / 2.0f, -1.f * GridWorldSize.Y / 2.0f, GetActorLocation().Z);
-	for (int y = 0; y < GridSizeY; y++)
+	// Publish all cells as unknown cells without tracing them if the grid streams tiles, tiles are baked once requested
+	if (bUseTileStreaming && !bSaveBakedGridOnPublish)
+	{
+		FGridBakeResult Result;
+		Result.BakeId = ++LatestBakeId;
+		BakeStartTime = FPlatformTime::Seconds();
+		Result.NumCells = GridSizeX * GridSizeY;
+		Result.WalkableBits.Init(bUnknownCellsWalkable, Result.NumCells);
+		Result.CellCosts.Init(FMath::Max<uint8>(UnknownCellCost, 1), Result.NumCells);
+		Result.bStreamed = true;
+		Result.CellOrigin = FVector2D(GetBottomLeftLocation());
+		Result.CellSize = NodeDiameter;
+		PublishGrid(Result);
+		return;
+	}
+	// Load the cells from the baked grid file instead of tracing them if it matches the level, unless the bake is done to rewrite the file
+	if (bUseBakedGridFile && !bSaveBakedGridOnPublish && LoadBakedGrid())
+	{
+		return;
+	}
+	// Give the bake a new id, so the result of a bake still running from an earlier call is discarded when it arrives
+	uint32 BakeId = ++LatestBakeId;
+	BakeStartTime = FPlatformTime::Seconds();
+	// Capture the layout of the grid, the worker threads don't read the actor transform
+	int32 SizeX = GridSizeX;
+	int32 SizeY = GridSizeY;
+	int32 TileSize = FMath::Max(BakeTileSize, 1);
+	FVector BottomLeftLocation = GetBottomLeftLocation();
+	float CellZ = GetActorLocation().Z;
+	float CellRadius = NodeRadius;
+	FCellTraceSettings TraceSettings = CaptureCellTraceSettings();
+	// Trace all cells on a worker task, splitting the grid in tiles traced in parallel, then hand the baked buffers to the game thread to be published
+	// The task only uses the captured values, the grid is only accessed back on the game thread through the weak pointer
+	TWeakObjectPtr<AGrid> WeakThis(this);
+	BakeTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, BakeId, SizeX, SizeY, TileSize, BottomLeftLocation, CellZ, CellRadius, TraceSettings = MoveTemp(TraceSettings)]()
 	{
-		for (int x = 0; x < GridSizeX; x++)
+		PATHFINDING_SCOPE(STAT_PathfindingGridBake);
+		// The world was torn down before the bake started, nothing to trace or publish, EndPlay waits for the task so it stays valid once checked
+		UWorld* World = TraceSettings.World.Get();
+		if (!World)
 		{
-			// Calculate center location of each new node to be added to the grid
-			FVector SpawnLocation = BottomLeftLocation + FVector(x * NodeDiameter + NodeRadius, y * NodeDiameter + NodeRadius, GetActorLocation().Z);
-			// Spawn new GridNode Actor in the calculated location
-			AGridNode* NewNode = GetWorld()->SpawnActor<AGridNode>(SpawnLocation, FRotator(0.0f, 0.0f, 0.0f));
-			// Set Different variables on the Node using the setNodeVariables function
-			NewNode->SetVariables(NodeRadius, MaxAllowedHeight, bGridVisible, x, y);
-			// Add the created Node to the GridNodes Array
-			NodesArray.Add(NewNode);
+			return;
+		}
+		TSharedRef<FGridBakeResult, ESPMode::ThreadSafe> Result = MakeShared<FGridBakeResult, ESPMode::ThreadSafe>();
+		Result->BakeId = BakeId;
+		Result->NumCells = SizeX * SizeY;
+		Result->CellOrigin = FVector2D(BottomLeftLocation);
+		Result->CellSize = CellRadius * 2;
+		Result->CellHeights.SetNumUninitialized(Result->NumCells);
+		Result->CellCosts.SetNumUninitialized(Result->NumCells);
+		// Tiles write the walkable state to a byte per cell, bits of neighboring tiles could share a word of the bit array
+		TArray<uint8> Walkable;
+		Walkable.SetNumUninitialized(Result->NumCells);
+		int32 NumTilesX = FMath::DivideAndRoundUp(SizeX, TileSize);
+		int32 NumTilesY = FMath::DivideAndRoundUp(SizeY, TileSize);
+		Result->NumTiles = NumTilesX * NumTilesY;
+		double TraceStartTime = FPlatformTime::Seconds();
+		ParallelFor(Result->NumTiles, [&](int32 TileIndex)
+		{
+			int32 MinX = (TileIndex % NumTilesX) * TileSize;
+			int32 MinY = (TileIndex / NumTilesX) * TileSize;
+			for (int32 y = MinY; y < FMath::Min(MinY + TileSize, SizeY); y++)
+			{
+				for (int32 x = MinX; x < FMath::Min(MinX + TileSize, SizeX); x++)
+				{
+					// Trace for ground and obstacles at the center location of each cell, same location as GetCellLocation
+					int32 CellIndex = y * SizeX + x;
+					FVector CellLocation = BottomLeftLocation + FVector(x * CellRadius * 2 + CellRadius, y * CellRadius * 2 + CellRadius, CellZ);
+					float CellHeight;
+					Walkable[CellIndex] = TraceCellWalkable(*World, CellLocation, TraceSettings, CellHeight, Result->CellCosts[CellIndex]);
+					Result->CellHeights[CellIndex] = CellHeight;
+				}
+			}
+		});
+		Result->TraceTimeMs = (FPlatformTime::Seconds() - TraceStartTime) * 1000.0;
+		// Pack the walkable states into the bit array
+		Result->WalkableBits.Init(false, Result->NumCells);
+		for (int32 CellIndex = 0; CellIndex < Result->NumCells; CellIndex++)
+		{
+			Result->WalkableBits[CellIndex] = Walkable[CellIndex] != 0;
+		}
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result]()
+		{
+			if (AGrid* Grid = WeakThis.Get())
+			{
+				Grid->PublishGrid(*Result);
+			}
+		});
+	});
+}
+
+void AGrid::BakeGridToFile()
+{
+	// Trace the cells even if a baked grid file exists, and save them when the bake is published
+	bSaveBakedGridOnPublish = true;
+	CreateGrid();
+}
+
+bool AGrid::LoadBakedGrid()
+{
+	PATHFINDING_SCOPE(STAT_PathfindingGridBake);
+	FString Path = GetBakedGridPath();
+	// Map the file instead of reading it, the sections are copied straight from the mapped pages into the cell buffers
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (!MappedFile)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No baked grid file found at %s, tracing the grid"), *Path);
+		return false;
+	}
+	int64 FileSize = MappedFile->GetFileSize();
+	TUniquePtr<IMappedFileRegion> MappedRegion(FileSize >= (int64)sizeof(FGridBakeFileHeader) ? MappedFile->MapRegion(0, FileSize) : nullptr);
+	if (!MappedRegion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked grid file %s couldn't be mapped, tracing the grid"), *Path);
+		return false;
+	}
+	const uint8* FileData = MappedRegion->GetMappedPtr();
+	FGridBakeFileHeader Header;
+	FMemory::Memcpy(&Header, FileData, sizeof(Header));
+	// The file is only used if it was baked with the same layout from the same level
+	if (Header.Magic != GridBakeFileMagic || Header.Version != GridBakeFileVersion || Header.GridSizeX != GridSizeX || Header.GridSizeY != GridSizeY || Header.NodeRadius != NodeRadius)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked grid file %s doesn't match the grid settings, tracing the grid"), *Path);
+		return false;
+	}
+	if (Header.LevelHash != CalculateLevelHash())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked grid file %s is older than the level, tracing the grid"), *Path);
+		return false;
+	}
+	// The layout matches the grid, so the cell count comes from its validated size, check each section lies inside the file without overflowing the offset sums
+	int32 NumFileCells = GridSizeX * GridSizeY;
+	int32 NumWords = FMath::DivideAndRoundUp(NumFileCells, NumBitsPerDWORD);
+	auto IsSectionInFile = [FileSize](uint64 Offset, uint64 Size)
+	{
+		return Offset <= (uint64)FileSize && Size <= (uint64)FileSize - Offset;
+	};
+	if (!IsSectionInFile(Header.WalkableOffset, uint64(NumWords) * sizeof(uint32)) || !IsSectionInFile(Header.HeightsOffset, uint64(NumFileCells) * sizeof(float)) || !IsSectionInFile(Header.CostsOffset, uint64(NumFileCells)))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked grid file %s is truncated, tracing the grid"), *Path);
+		return false;
+	}
+	// Copy each section into the cell buffers in one go, they stay owned by the grid because RebakeRegion changes them
+	FGridBakeResult Result;
+	Result.NumCells = NumFileCells;
+	Result.CellOrigin = FVector2D(GetBottomLeftLocation());
+	Result.CellSize = NodeRadius * 2;
+	Result.WalkableBits.Init(false, NumFileCells);
+	if (NumWords > 0)
+	{
+		FMemory::Memcpy(Result.WalkableBits.GetData(), FileData + Header.WalkableOffset, NumWords * sizeof(uint32));
+		// Clear the bits past the last cell, the bit array expects them to be unset
+		if (NumFileCells % NumBitsPerDWORD != 0)
+		{
+			Result.WalkableBits.GetData()[NumWords - 1] &= (1u << (NumFileCells % NumBitsPerDWORD)) - 1;
 		}
 	}
-	UE_LOG(LogTemp, Warning, TEXT("Number of Nodes added: %i"), NodesArray.Num());
+	Result.CellHeights.SetNumUninitialized(NumFileCells);
+	FMemory::Memcpy(Result.CellHeights.GetData(), FileData + Header.HeightsOffset, NumFileCells * sizeof(float));
+	Result.CellCosts.SetNumUninitialized(NumFileCells);
+	FMemory::Memcpy(Result.CellCosts.GetData(), FileData + Header.CostsOffset, NumFileCells);
+	// Cell costs are multipliers, a cost of 0 means the file is corrupted
+	if (Result.CellCosts.Contains(0))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Baked grid file %s has invalid cell costs, tracing the grid"), *Path);
+		return false;
+	}
+	// Publish the loaded cells like a finished bake, discarding any bake still running
+	Result.BakeId = ++LatestBakeId;
+	BakeStartTime = FPlatformTime::Seconds();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	UE_LOG(LogTemp, Log, TEXT("Grid loaded from baked grid file %s"), *Path);
+	PublishGrid(Result);
+	return true;
 }
 
-AGridNode* AGrid::NodeFromLocation(FVector WorldLocation)
+FString AGrid::GetBakedGridPath() const
 {
-	// Calculate the Bottom left corner and top right corner world locations 
-	FVector BottomLeftLocation = GetActorLocation() + FVector(-1.f * GridWorldSize.X / 2.0f, -1.f * GridWorldSize.Y / 2.0f, GetActorLocation().Z);
-	FVector TopRightLocation = GetActorLocation() + FVector(GridWorldSize.X / 2.0f, GridWorldSize.Y / 2.0f, GetActorLocation().Z);
-	// Ensure the input location is withtin the bounds of bottom left and top right corner locations
-	if ((WorldLocation.X >= BottomLeftLocation.X && WorldLocation.X <= TopRightLocation.X) && (WorldLocation.Y >= BottomLeftLocation.Y && WorldLocation.Y <= TopRightLocation.Y))
-	{
-		// Get the input locaton relative to the bottom left corner
-		FVector RelativeLocation = WorldLocation - BottomLeftLocation;
-		// Normalize the relative location with the distance between bottom left and top right corner in the X and Y directions
-		FVector RelativeLocationFrac;
-		RelativeLocationFrac.X = RelativeLocation.X / (TopRightLocation.X - BottomLeftLocation.X);
-		RelativeLocationFrac.Y = RelativeLocation.Y / (TopRightLocation.Y - BottomLeftLocation.Y);
-		// Multiply the fractions in each direction by the GridSizeX and GridSizeY respectively to get the X and Y indices on the GridArray
-		float Xindex = UKismetMathLibrary::Round(RelativeLocationFrac.X * (GridSizeX - 1));
-		float Yindex = UKismetMathLibrary::Round(RelativeLocationFrac.Y * (GridSizeY - 1));
-		// Get the node from array with XIndex and YIndex
-		AGridNode* ReturnNode = NodesArray[Yindex * GridSizeX + Xindex];
-		// Check if GridNode is valid if so return it, else return nullptr
-		if (ReturnNode)
-			return ReturnNode;
-		else
-			return nullptr;
+	if (!BakedGridFile.IsEmpty())
+	{
+		return FPaths::Combine(FPaths::ProjectContentDir(), BakedGridFile);
 	}
-	// If input location outside the bounds specified, return nullptr
-	else
+	// Name the file after the level and the grid actor, so each grid of each level has its own file, PIE prefixes are removed so the editor and PIE share the file
+	FString LevelName = FPackageName::GetShortName(UWorld::RemovePIEPrefix(GetPackage()->GetName()));
+	return FPaths::Combine(FPaths::ProjectContentDir(), TEXT("BakedGrids"), FString::Printf(TEXT("%s_%s.gridbake"), *LevelName, *GetName()));
+}
+
+bool AGrid::SaveBakedGrid() const
+{
+	FGridBakeFileHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = GridBakeFileMagic;
+	Header.Version = GridBakeFileVersion;
+	Header.GridSizeX = GridSizeX;
+	Header.GridSizeY = GridSizeY;
+	Header.NodeRadius = NodeRadius;
+	Header.LevelHash = CalculateLevelHash();
+	// Lay out the sections one after the other, aligned so they can be read in place
+	int32 NumWords = FMath::DivideAndRoundUp(NumCells, NumBitsPerDWORD);
+	Header.WalkableOffset = Align(sizeof(Header), GridBakeFileAlignment);
+	Header.HeightsOffset = Align(Header.WalkableOffset + NumWords * sizeof(uint32), GridBakeFileAlignment);
+	Header.CostsOffset = Align(Header.HeightsOffset + NumCells * sizeof(float), GridBakeFileAlignment);
+	TArray<uint8> FileData;
+	FileData.SetNumZeroed(Header.CostsOffset + NumCells);
+	FMemory::Memcpy(FileData.GetData(), &Header, sizeof(Header));
+	if (NumWords > 0)
 	{
-		return nullptr;
+		FMemory::Memcpy(FileData.GetData() + Header.WalkableOffset, WalkableBits.GetData(), NumWords * sizeof(uint32));
+	}
+	FMemory::Memcpy(FileData.GetData() + Header.HeightsOffset, CellHeights.GetData(), NumCells * sizeof(float));
+	FMemory::Memcpy(FileData.GetData() + Header.CostsOffset, CellCosts.GetData(), NumCells);
+	FString Path = GetBakedGridPath();
+	if (!FFileHelper::SaveArrayToFile(FileData, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Baked grid file %s couldn't be written"), *Path);
+		return false;
 	}
+	UE_LOG(LogTemp, Warning, TEXT("Grid baked to file %s (%i bytes)"), *Path, FileData.Num());
+	return true;
 }
 
-TArray<AGridNode*> AGrid::GetNeighborNodes(AGridNode* Node)
+uint64 AGrid::CalculateLevelHash() const
 {
-	// Create TArray of GridNodes to store neighbor nodes
-	TArray<AGridNode*> NeighborNodes;
-	// Set the start location as the X and Y indices of the input Node
-	int StartX = Node->GetGridIndexX();
-	int StartY = Node->GetGridIndexY();
-	// Iterate from -1 to +1 from the start location in the X and Y direction to get the 8 neighbor nodes if valid
-	for (int y = -1; y <= 1; y++)
+	// Write everything the traced cells depend on to a buffer and hash it
+	TArray<uint8> HashData;
+	FMemoryWriter Writer(HashData);
+	int32 SizeX = GridSizeX;
+	int32 SizeY = GridSizeY;
+	float Radius = NodeRadius;
+	float AllowedHeight = MaxAllowedHeight;
+	float GroundDistance = GroundDetection;
+	FVector Location = GetActorLocation();
+	Writer << SizeX << SizeY << Radius << AllowedHeight << GroundDistance << Location;
+	FCellCostRules CostRules = CaptureCellCostRules();
+	Writer << CostRules.DefaultCost;
+	TArray<FString> MaterialNames;
+	for (const auto& Pair : CostRules.MaterialCosts)
+	{
+		MaterialNames.Add(FString::Printf(TEXT("%s=%i"), *Pair.Key->GetPathName(), Pair.Value));
+	}
+	MaterialNames.Sort();
+	Writer << MaterialNames;
+	for (TPair<FBox, uint8>& Volume : CostRules.VolumeCosts)
+	{
+		Writer << Volume.Key << Volume.Value;
+	}
+	// Hash the name and the bounds of every colliding component that isn't movable over the grid, sorted so the order of the actors doesn't matter
+	// Bounds are rounded to a tenth of a unit, so saving the level again doesn't change the hash
+	FBox GridBounds(GetBottomLeftLocation() - FVector(0.0f, 0.0f, HALF_WORLD_MAX), GetBottomLeftLocation() + FVector(GridWorldSize.X, GridWorldSize.Y, HALF_WORLD_MAX));
+	TArray<uint64> ComponentHashes;
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
 	{
-		for (int x = -1; x <= 1; x++)
+		AActor* Actor = *It;
+		if (Actor == this || Actor->IsA<AGridNode>())
+		{
+			continue;
+		}
+		for (UActorComponent* Component : Actor->GetComponents())
 		{
-			if (x == 0 && y == 0)
+			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Component);
+			if (!Primitive || !Primitive->IsRegistered() || Primitive->Mobility == EComponentMobility::Movable || !Primitive->IsCollisionEnabled())
+			{
+				continue;
+			}
+			FBox Bounds = Primitive->Bounds.GetBox();
+			if (!Bounds.IntersectXY(GridBounds))
 			{
-				// If X=Y=0, we are pointing at the input node, we skip since it's not added to the neighbor nodes
 				continue;
 			}
-			// Calculate IndexX and IndexY for each neighbor node, and ensure they are withing the range of valid indices
-			int indexX = StartX + x;
-			int indexY = StartY + y;
-			if ((indexX >= 0 && indexX < GridSizeX) && (indexY >= 0 && indexY < GridSizeY))
+			FString ComponentKey = FString::Printf(TEXT("%s.%s %lld %lld %lld %lld %lld %lld"), *Actor->GetName(), *Primitive->GetName(),
+				FMath::RoundToInt64(Bounds.Min.X * 10.0), FMath::RoundToInt64(Bounds.Min.Y * 10.0), FMath::RoundToInt64(Bounds.Min.Z * 10.0),
+				FMath::RoundToInt64(Bounds.Max.X * 10.0), FMath::RoundToInt64(Bounds.Max.Y * 10.0), FMath::RoundToInt64(Bounds.Max.Z * 10.0));
+			FTCHARToUTF8 KeyUtf8(*ComponentKey);
+			ComponentHashes.Add(CityHash64(KeyUtf8.Get(), KeyUtf8.Length()));
+		}
+	}
+	ComponentHashes.Sort();
+	Writer << ComponentHashes;
+	return CityHash64((const char*)HashData.GetData(), HashData.Num());
+}
+
+bool AGrid::IsCreatingGrid() const
+{
+	return PublishedBakeId != LatestBakeId;
+}
+
+double AGrid::GetLastBakeTimeMs() const
+{
+	return LastBakeTimeMs;
+}
+
+void AGrid::PublishGrid(FGridBakeResult& Result)
+{
+	PATHFINDING_SCOPE(STAT_PathfindingGridPublish);
+	// Discard the result if CreateGrid was called again since this bake started
+	if (Result.BakeId != LatestBakeId)
+	{
+		return;
+	}
+	PublishedBakeId = Result.BakeId;
+	{
+		// Hold the cell data lock for writing, so asynchronous searches don't read the cell buffers while they are replaced
+		FWriteScopeLock CellDataWriteLock(CellDataLock);
+		// Swap in the baked cell buffers, and free the search contexts sized to the last grid
+		NumCells = Result.NumCells;
+		UpdateNeighborOffsets();
+		QueryContextPool.Empty();
+		PathCache.Empty();
+		PathCache.SetMaxMemory(int64(PathCacheMaxMemoryKB) * 1024);
+		FlowFields.Empty();
+		FlowFieldGoals.Empty();
+		// Split the grid in streaming tiles if it streams them, all tiles start unloaded
+		bTileStreamingActive = Result.bStreamed;
+		TileCellSize = FMath::Max(StreamingTileSize, 1);
+		NumTilesX = bTileStreamingActive ? FMath::DivideAndRoundUp(GridSizeX, TileCellSize) : 0;
+		StreamingTiles.Empty();
+		StreamingTiles.SetNum(bTileStreamingActive ? NumTilesX * FMath::DivideAndRoundUp(GridSizeY, TileCellSize) : 0);
+		ResidentTiles.Empty();
+		// Keep the layout the cells were baked with, so locations are mapped to the cells traced there
+		CellLookupOrigin = Result.CellOrigin;
+		CellLookupSize = FMath::Max(Result.CellSize, UE_DOUBLE_SMALL_NUMBER);
+		CellLookupInverseSize = 1.0 / CellLookupSize;
+		WalkableBits = MoveTemp(Result.WalkableBits);
+		CellHeights = MoveTemp(Result.CellHeights);
+		CellCosts = MoveTemp(Result.CellCosts);
+		// Count the cells of each cost
+		FMemory::Memzero(CellCostCounts, sizeof(CellCostCounts));
+		for (uint8 Cost : CellCosts)
+		{
+			CellCostCounts[Cost]++;
+		}
+		// Bake the jump distances of all rows and columns from the walkable state of the cells, grids streaming tiles are too large for the jump distance tables
+		JumpDistances.Empty();
+		if (!bTileStreamingActive)
+		{
+			JumpDistances.SetNumZeroed(NumCells * (int32)EGridDirection::Num);
+			for (int32 y = 0; y < GridSizeY; y++)
+			{
+				BakeJumpDistances(y, EGridDirection::East);
+				BakeJumpDistances(y, EGridDirection::West);
+			}
+			for (int32 x = 0; x < GridSizeX; x++)
 			{
-				// Add each neighbor node to the NeighborNodes array 
-				int index = indexX + indexY * GridSizeX;
-				NeighborNodes.Add(NodesArray[index]);
+				BakeJumpDistances(x, EGridDirection::North);
+				BakeJumpDistances(x, EGridDirection::South);
 			}
 		}
+		// Build the cluster graph from the walkable state of the cells if hierarchical pathfinding is used
+		if (bBuildClusterGraph)
+		{
+			ClusterGraph.Build(*this, ClusterSize);
+		}
+		else
+		{
+			ClusterGraph.Reset();
+		}
+		// Move to the next version with no recorded changes, so every path found on the last grid is reported as changed
+		uint32 NewVersion = GridVersion.load(std::memory_order_relaxed) + 1;
+		RegionChanges.Reset();
+		OldestTrackedVersion = NewVersion;
+		GridVersion.store(NewVersion, std::memory_order_relaxed);
+	}
+	// Save the cells to the baked grid file if the bake was started by BakeGridToFile, node actors aren't needed for it
+	bool bSavingBakedGrid = bSaveBakedGridOnPublish;
+	if (bSavingBakedGrid)
+	{
+		bSaveBakedGridOnPublish = false;
+		SaveBakedGrid();
+	}
+	// Destroy GridNodes spawned by a previous call, the grid data doesn't depend on them
+	for (auto& Node : NodesArray)
+	{
+		Node->Destroy();
+	}
+	NodesArray.Reset();
+	// Create the instanced cell view if it's used, it replaces the GridNode actors
+	BuildCellView();
+	// Spawn a GridNode actor at the center of each cell only if they are used to visualize the grid, actors can only be spawned on the game thread
+	if (bSpawnNodeActors && !bUseInstancedCellView && !bSavingBakedGrid)
+	{
+		NodesArray.Reserve(NumCells);
+		for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+		{
+			// Spawn new GridNode Actor in the cell location
+			AGridNode* NewNode = GetWorld()->SpawnActor<AGridNode>(GetCellLocation(CellIndex), FRotator(0.0f, 0.0f, 0.0f));
+			// Set Different variables on the Node using the setNodeVariables function, with the walkable state baked for its cell
+			NewNode->SetVariables(NodeRadius, MaxAllowedHeight, bGridVisible, GetCellX(CellIndex), GetCellY(CellIndex), IsCellWalkable(CellIndex));
+			// Add the created Node to the GridNodes Array
+			NodesArray.Add(NewNode);
+		}
+	}
+	// Print to log the number of cells, and the time taken by the traces and the whole bake
+	LastBakeTimeMs = (FPlatformTime::Seconds() - BakeStartTime) * 1000.0;
+	UE_LOG(LogTemp, Warning, TEXT("Number of Nodes added: %i"), NumCells);
+	UE_LOG(LogTemp, Warning, TEXT("Grid baked in %f milliseconds (%i tiles traced in %f milliseconds)"), LastBakeTimeMs, Result.NumTiles, Result.TraceTimeMs);
+	OnGridCreated.Broadcast();
+	// Bake the tiles around the streaming sources now, then keep checking them
+	if (bTileStreamingActive)
+	{
+		GetWorldTimerManager().SetTimer(StreamingTimerHandle, this, &AGrid::UpdateStreaming, FMath::Max(StreamingUpdateInterval, 0.01f), true);
+		UpdateStreaming();
 	}
+	else
+	{
+		GetWorldTimerManager().ClearTimer(StreamingTimerHandle);
+	}
+}
+
+AGridNode* AGrid::NodeFromLocation(FVector WorldLocation)
+{
+	// Get the node actor of the cell containing the input location, nullptr if location outside the grid or node actors not spawned
+	return GetCellNode(CellFromLocation(WorldLocation));
+}
+
+TArray<AGridNode*> AGrid::GetNeighborNodes(AGridNode* Node)
+{
+	// Create TArray of GridNodes to store neighbor nodes
+	TArray<AGridNode*> NeighborNodes;
+	// Iterate over the neighbor cells of the input Node cell, and add the node actor of each one to the NeighborNodes array
+	ForEachNeighborCell(GetCellIndex(Node->GetGridIndexX(), Node->GetGridIndexY()), [this, &NeighborNodes](int32 NeighborCell)
+	{
+		if (AGridNode* NeighborNode = GetCellNode(NeighborCell))
+		{
+			NeighborNodes.Add(NeighborNode);
+		}
+	});
 	// return the NeighborNodes array
 	return NeighborNodes;
 }
 
+int32 AGrid::CellFromLocation(FVector WorldLocation) const
+{
+	// Same lookup as a batch of one location, so single and batched lookups always agree
+	int32 CellIndex = INDEX_NONE;
+	CellsFromLocations(MakeArrayView(&WorldLocation, 1), MakeArrayView(&CellIndex, 1));
+	return CellIndex;
+}
+
+int32 AGrid::CellsFromLocations(TArrayView<const FVector> Locations, TArrayView<int32> OutCells) const
+{
+	check(OutCells.Num() >= Locations.Num());
+	// Grid not created yet, all locations are outside it
+	if (NumCells == 0 || GridSizeX <= 0)
+	{
+		for (int32 Index = 0; Index < Locations.Num(); Index++)
+		{
+			OutCells[Index] = INDEX_NONE;
+		}
+		return Locations.Num();
+	}
+	// Read the layout of the published cells once, cell X covers [X * CellSize, (X + 1) * CellSize) from the origin, centered where CreateGrid traced it
+	const int32 SizeX = GridSizeX;
+	const int32 SizeY = NumCells / GridSizeX;
+	const double OriginX = CellLookupOrigin.X;
+	const double OriginY = CellLookupOrigin.Y;
+	const double CellSize = CellLookupSize;
+	const double InverseSize = CellLookupInverseSize;
+	const double MaxRelativeX = SizeX * CellSize;
+	const double MaxRelativeY = SizeY * CellSize;
+	int32 NumOutside = 0;
+	for (int32 Index = 0; Index < Locations.Num(); Index++)
+	{
+		// The loop body has no branches so the compiler can vectorize it, indices are clamped before the conversion so far away locations don't overflow
+		double RelativeX = Locations[Index].X - OriginX;
+		double RelativeY = Locations[Index].Y - OriginY;
+		int32 X = (int32)FMath::Clamp(FMath::FloorToDouble(RelativeX * InverseSize), -1.0, (double)SizeX);
+		int32 Y = (int32)FMath::Clamp(FMath::FloorToDouble(RelativeY * InverseSize), -1.0, (double)SizeY);
+		// Multiplying by the inverse size can round a location next to a cell border into the wrong cell, move it back across the border it's on the other side of
+		X += int32(RelativeX >= (X + 1) * CellSize) - int32(RelativeX < X * CellSize);
+		Y += int32(RelativeY >= (Y + 1) * CellSize) - int32(RelativeY < Y * CellSize);
+		bool bInside = (RelativeX >= 0.0) & (RelativeX <= MaxRelativeX) & (RelativeY >= 0.0) & (RelativeY <= MaxRelativeY);
+		X = FMath::Min(X, SizeX - 1);
+		Y = FMath::Min(Y, SizeY - 1);
+		OutCells[Index] = bInside ? Y * SizeX + X : INDEX_NONE;
+		NumOutside += bInside ? 0 : 1;
+	}
+	return NumOutside;
+}
+
+void AGrid::GetNeighborCells(int32 CellIndex, TArray<int32>& OutNeighborCells) const
+{
+	// Empty the input array, keeping its memory so it can be reused by the caller, and add each neighbor cell to it
+	OutNeighborCells.Reset();
+	ForEachNeighborCell(CellIndex, [&OutNeighborCells](int32 NeighborCell)
+	{
+		OutNeighborCells.Add(NeighborCell);
+	});
+}
+
+uint8 AGrid::GetNeighborMask(int32 CellIndex) const
+{
+	// Bits of the neighbor directions on each side of the cell, in NeighborOffsets order
+	constexpr uint8 WestMask = 0b00101001;
+	constexpr uint8 EastMask = 0b10010100;
+	constexpr uint8 SouthMask = 0b00000111;
+	constexpr uint8 NorthMask = 0b11100000;
+	// Start with all 8 directions and clear the ones crossing a grid edge
+	int32 IndexX = GetCellX(CellIndex);
+	int32 IndexY = GetCellY(CellIndex);
+	uint8 Mask = 0xFF;
+	if (IndexX == 0)
+	{
+		Mask &= ~WestMask;
+	}
+	if (IndexX == GridSizeX - 1)
+	{
+		Mask &= ~EastMask;
+	}
+	if (IndexY == 0)
+	{
+		Mask &= ~SouthMask;
+	}
+	if (IndexY == GridSizeY - 1)
+	{
+		Mask &= ~NorthMask;
+	}
+	return Mask;
+}
+
+void AGrid::UpdateNeighborOffsets()
+{
+	// Offset of each direction in the same order as the neighbor mask bits
+	for (int32 Direction = 0; Direction < 8; Direction++)
+	{
+		NeighborOffsets[Direction] = NeighborDirectionsY[Direction] * GridSizeX + NeighborDirectionsX[Direction];
+	}
+}
+
+bool AGrid::HasLineOfSight(int32 FromCell, int32 ToCell, uint8 MaxCellCost) const
+{
+	auto IsCellOpen = [this, MaxCellCost](int32 CellIndex)
+	{
+		return IsCellWalkable(CellIndex) && CellCosts[CellIndex] <= MaxCellCost;
+	};
+	if (!IsCellOpen(FromCell))
+	{
+		return false;
+	}
+	int32 PreviousCell = FromCell;
+	return ForEachCellOnLine(FromCell, ToCell, [this, &IsCellOpen, &PreviousCell](int32 CellIndex)
+	{
+		// A diagonal step moves both X and Y, the cells beside the corner are the previous cell moved along only one of them
+		int32 StepX = GetCellX(CellIndex) - GetCellX(PreviousCell);
+		int32 StepY = GetCellY(CellIndex) - GetCellY(PreviousCell);
+		if (StepX != 0 && StepY != 0 && (!IsCellOpen(PreviousCell + StepX) || !IsCellOpen(CellIndex - StepX)))
+		{
+			return false;
+		}
+		PreviousCell = CellIndex;
+		return IsCellOpen(CellIndex);
+	});
+}
+
+FVector AGrid::GetCellLocation(int32 CellIndex) const
+{
+	// Calculate center location of the cell from its X and Y indices, offset from the bottom left corner of the grid
+	float NodeDiameter = NodeRadius * 2;
+	return GetBottomLeftLocation() + FVector(GetCellX(CellIndex) * NodeDiameter + NodeRadius, GetCellY(CellIndex) * NodeDiameter + NodeRadius, GetActorLocation().Z);
+}
+
+int32 AGrid::GetCellIndex(int32 IndexX, int32 IndexY) const
+{
+	return IndexY * GridSizeX + IndexX;
+}
+
+int32 AGrid::GetCellX(int32 CellIndex) const
+{
+	return CellIndex % GridSizeX;
+}
+
+int32 AGrid::GetCellY(int32 CellIndex) const
+{
+	return CellIndex / GridSizeX;
+}
+
+int32 AGrid::GetNumCells() const
+{
+	return NumCells;
+}
+
+bool AGrid::IsCellWalkable(int32 CellIndex) const
+{
+	// Read the walkable bit of the cell, cells outside the grid are unwalkable
+	return WalkableBits.IsValidIndex(CellIndex) && WalkableBits[CellIndex];
+}
+
+float AGrid::GetCellHeight(int32 CellIndex) const
+{
+	if (!bTileStreamingActive)
+	{
+		return CellHeights[CellIndex];
+	}
+	// Read the height from the streaming tile of the cell, unknown cells have no ground so their height is the cell height like cells without ground
+	int32 TileIndex = GetTileIndex(CellIndex);
+	const FGridStreamingTile& Tile = StreamingTiles[TileIndex];
+	if (Tile.CellHeights.IsEmpty())
+	{
+		return GetCellLocation(CellIndex).Z;
+	}
+	FIntPoint TileMin, TileMax;
+	GetTileBounds(TileIndex, TileMin, TileMax);
+	return Tile.CellHeights[(GetCellY(CellIndex) - TileMin.Y) * (TileMax.X - TileMin.X + 1) + GetCellX(CellIndex) - TileMin.X];
+}
+
+uint8 AGrid::GetCellCost(int32 CellIndex) const
+{
+	return CellCosts[CellIndex];
+}
+
+int32 AGrid::GetMoveCost(int32 FromCell, int32 ToCell, int32 BaseCost) const
+{
+	// Base costs are even, so half the move is charged at the cost of each cell without rounding
+	return BaseCost * (CellCosts[FromCell] + CellCosts[ToCell]) / 2;
+}
+
+int32 AGrid::GetMinCellCost() const
+{
+	// Find the first cost with cells, starting from the cheapest possible cost
+	for (int32 Cost = 1; Cost < UE_ARRAY_COUNT(CellCostCounts); Cost++)
+	{
+		if (CellCostCounts[Cost] > 0)
+		{
+			return Cost;
+		}
+	}
+	return 1;
+}
+
+bool AGrid::HasUniformCellCosts() const
+{
+	return NumCells == 0 || CellCostCounts[GetMinCellCost()] == NumCells;
+}
+
+void AGrid::SetCellCost(int32 CellIndex, uint8 Cost)
+{
+	CellCostCounts[CellCosts[CellIndex]]--;
+	CellCostCounts[Cost]++;
+	CellCosts[CellIndex] = Cost;
+}
+
+AGridNode* AGrid::GetCellNode(int32 CellIndex) const
+{
+	// Node actors only exist if they were spawned by CreateGrid
+	if (NodesArray.IsValidIndex(CellIndex))
+	{
+		return NodesArray[CellIndex];
+	}
+	return nullptr;
+}
+
+void AGrid::HighlightCell(int32 CellIndex, FColor Color, float Opacity)
+{
+	if (HasCellView())
+	{
+		SetCellViewColor(CellIndex, Color, Opacity);
+		return;
+	}
+	// Change the color of the node actor visualizing the cell and make it visible
+	if (AGridNode* Node = GetCellNode(CellIndex))
+	{
+		Node->ChangeColor(Color, Opacity);
+		Node->setNodeVisibility(true);
+	}
+}
+
+void AGrid::HighlightCells(TArrayView<const int32> Cells, FColor Color, float Opacity)
+{
+	for (int32 CellIndex : Cells)
+	{
+		HighlightCell(CellIndex, Color, Opacity);
+	}
+}
+
+void AGrid::ResetCellHighlight(int32 CellIndex)
+{
+	// Show the cell view instance like a hidden GridNode, unwalkable cells in red, walkable cells in blue only if the grid is visible
+	if (HasCellView())
+	{
+		bool bWalkable = IsCellWalkable(CellIndex);
+		SetCellViewColor(CellIndex, bWalkable ? FColor::Blue : FColor::Red, (bWalkable && !bGridVisible) ? 0.0f : 0.5f);
+		return;
+	}
+	// Set the node actor visualizing the cell to invisible and change its color to the default color
+	if (AGridNode* Node = GetCellNode(CellIndex))
+	{
+		Node->setNodeVisibility(false);
+		Node->SetColorOnWalkable();
+	}
+}
+
+void AGrid::BuildCellView()
+{
+	CellInstances->ClearInstances();
+	if (!bUseInstancedCellView)
+	{
+		return;
+	}
+	// Add an instance at the center of each cell in one batch, scaled like the GridNode plane
+	CellInstances->SetMaterial(0, CellViewMaterial);
+	CellInstances->SetNumCustomDataFloats(4);
+	float ScalePercentage = (NodeRadius * 2 - 5.0f) / 100.0f;
+	TArray<FTransform> InstanceTransforms;
+	InstanceTransforms.Reserve(NumCells);
+	for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+	{
+		InstanceTransforms.Add(FTransform(FQuat::Identity, GetCellLocation(CellIndex), FVector(ScalePercentage)));
+	}
+	CellInstances->AddInstances(InstanceTransforms, false, true);
+	// Color every cell by its walkable state, the render state is updated once on the next tick
+	for (int32 CellIndex = 0; CellIndex < NumCells; CellIndex++)
+	{
+		ResetCellHighlight(CellIndex);
+	}
+}
+
+bool AGrid::HasCellView() const
+{
+	return bUseInstancedCellView && CellInstances->GetInstanceCount() == NumCells && NumCells > 0;
+}
+
+void AGrid::SetCellViewColor(int32 CellIndex, FColor Color, float Opacity)
+{
+	// Colors are converted like the Color parameter of the GridNode material
+	FLinearColor LinearColor(Color);
+	float CustomData[4] = { LinearColor.R, LinearColor.G, LinearColor.B, Opacity };
+	CellInstances->SetCustomData(CellIndex, CustomData, false);
+	// All cells changed before the next tick are sent to the renderer together
+	if (!bCellViewFlushPending)
+	{
+		bCellViewFlushPending = true;
+		GetWorldTimerManager().SetTimerForNextTick(this, &AGrid::FlushCellView);
+	}
+}
+
+void AGrid::FlushCellView()
+{
+	bCellViewFlushPending = false;
+	CellInstances->MarkRenderStateDirty();
+}
+
 void AGrid::CreateGridMesh()
 {
 	// Calculate the Bottomleft corner location of the Grid
@@ -189,12 +902,727 @@ void AGrid::CreateLine(FVector StartLocation, FVector EndLocation, float LineThi
 	Vertices.Append(VerticesSubArray);
 }
 
-FVector2D AGrid::GetGridWorldSize()
+bool AGrid::IsNodeWalkable(const AGridNode* Node) const
 {
-	// Calculate the value of GridWorldSize based on GridSizeX and GridSizeY
-	float NodeDiameter = NodeRadius * 2;
-	GridWorldSize.X = GridSizeX * NodeDiameter;
-	GridWorldSize.Y = GridSizeY * NodeDiameter;
-	return GridWorldSize;
+	return IsWalkable(Node->GetGridIndexX(), Node->GetGridIndexY());
 }
 
+bool AGrid::IsWalkable(int32 IndexX, int32 IndexY) const
+{
+	// Nodes outside the grid are unwalkable
+	if (IndexX < 0 || IndexX >= GridSizeX || IndexY < 0 || IndexY >= GridSizeY)
+	{
+		return false;
+	}
+	return IsCellWalkable(GetCellIndex(IndexX, IndexY));
+}
+
+void AGrid::RebakeRegion(FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	PATHFINDING_SCOPE(STAT_PathfindingRebakeRegion);
+	// Clamp the region to the indices of the baked cells
+	int32 MinX = FMath::Max(MinIndex.X, 0);
+	int32 MinY = FMath::Max(MinIndex.Y, 0);
+	int32 MaxX = FMath::Min(MaxIndex.X, GridSizeX - 1);
+	int32 MaxY = FMath::Min(MaxIndex.Y, NumCells / FMath::Max(GridSizeX, 1) - 1);
+	if (MinX > MaxX || MinY > MaxY)
+	{
+		return;
+	}
+	// Rerun the traces of each cell in the region into local buffers without holding the cell data lock, so searches keep running during the physics queries
+	// Cells of tiles that aren't resident stay unknown cells and aren't traced
+	FCellTraceSettings TraceSettings = CaptureCellTraceSettings();
+	UWorld* World = GetWorld();
+	int32 RegionSizeX = MaxX - MinX + 1;
+	int32 NumRegionCells = RegionSizeX * (MaxY - MinY + 1);
+	TArray<uint8> RegionWalkable;
+	TArray<float> RegionHeights;
+	TArray<uint8> RegionCosts;
+	RegionWalkable.SetNumZeroed(NumRegionCells);
+	RegionHeights.SetNumZeroed(NumRegionCells);
+	RegionCosts.SetNumZeroed(NumRegionCells);
+	for (int32 y = MinY; y <= MaxY; y++)
+	{
+		for (int32 x = MinX; x <= MaxX; x++)
+		{
+			int32 CellIndex = GetCellIndex(x, y);
+			if (!IsCellResident(CellIndex))
+			{
+				continue;
+			}
+			int32 RegionCell = (y - MinY) * RegionSizeX + x - MinX;
+			RegionWalkable[RegionCell] = TraceCellWalkable(*World, GetCellLocation(CellIndex), TraceSettings, RegionHeights[RegionCell], RegionCosts[RegionCell]);
+		}
+	}
+	// Bounds of the cells whose walkable state or cost changed, empty if none changed
+	FIntPoint ChangedMin(MAX_int32, MAX_int32);
+	FIntPoint ChangedMax(INDEX_NONE, INDEX_NONE);
+	{
+		// Hold the cell data lock for writing only while the traced cells are stored in the cell buffers, tiles are only loaded and unloaded on the game thread so residency is unchanged
+		FWriteScopeLock CellDataWriteLock(CellDataLock);
+		for (int32 y = MinY; y <= MaxY; y++)
+		{
+			for (int32 x = MinX; x <= MaxX; x++)
+			{
+				int32 CellIndex = GetCellIndex(x, y);
+				int32 RegionCell = (y - MinY) * RegionSizeX + x - MinX;
+				// Unknown cells weren't traced, their cost is left at 0
+				if (RegionCosts[RegionCell] == 0)
+				{
+					continue;
+				}
+				SetCellHeight(CellIndex, RegionHeights[RegionCell]);
+				if (SetCellState(CellIndex, RegionWalkable[RegionCell] != 0, RegionCosts[RegionCell]))
+				{
+					ChangedMin = FIntPoint(FMath::Min(ChangedMin.X, x), FMath::Min(ChangedMin.Y, y));
+					ChangedMax = FIntPoint(FMath::Max(ChangedMax.X, x), FMath::Max(ChangedMax.Y, y));
+				}
+			}
+		}
+		// Nothing else depends on the cell heights, so the data derived from the walkable state and costs is only rebaked if a cell changed
+		if (ChangedMax.X == INDEX_NONE)
+		{
+			return;
+		}
+		CommitRegionChange(ChangedMin, ChangedMax);
+	}
+	// Notify listeners after releasing the lock, so they can run searches on the new cells
+	OnGridRegionChanged.Broadcast(ChangedMin, ChangedMax);
+}
+
+bool AGrid::SetCellState(int32 CellIndex, bool bWalkable, uint8 Cost)
+{
+	bool bWalkableChanged = bWalkable != WalkableBits[CellIndex];
+	if (!bWalkableChanged && Cost == CellCosts[CellIndex])
+	{
+		return false;
+	}
+	WalkableBits[CellIndex] = bWalkable;
+	SetCellCost(CellIndex, Cost);
+	// Update the color of the node actor or cell view instance visualizing the cell
+	AGridNode* Node = GetCellNode(CellIndex);
+	if (Node && bWalkableChanged)
+	{
+		Node->SetWalkable(bWalkable);
+		Node->SetColorOnWalkable();
+	}
+	if (bWalkableChanged && HasCellView())
+	{
+		ResetCellHighlight(CellIndex);
+	}
+	return true;
+}
+
+void AGrid::SetCellHeight(int32 CellIndex, float Height)
+{
+	if (!bTileStreamingActive)
+	{
+		CellHeights[CellIndex] = Height;
+		return;
+	}
+	int32 TileIndex = GetTileIndex(CellIndex);
+	FGridStreamingTile& Tile = StreamingTiles[TileIndex];
+	if (!Tile.CellHeights.IsEmpty())
+	{
+		FIntPoint TileMin, TileMax;
+		GetTileBounds(TileIndex, TileMin, TileMax);
+		Tile.CellHeights[(GetCellY(CellIndex) - TileMin.Y) * (TileMax.X - TileMin.X + 1) + GetCellX(CellIndex) - TileMin.X] = Height;
+	}
+}
+
+void AGrid::CommitRegionChange(FIntPoint ChangedMin, FIntPoint ChangedMax)
+{
+	// Jump distances along a row or column depend on the walkable state of the cells on it and on the adjacent rows or columns, rebake all lines the changed cells could affect
+	if (!JumpDistances.IsEmpty())
+	{
+		for (int32 y = FMath::Max(ChangedMin.Y - 1, 0); y <= FMath::Min(ChangedMax.Y + 1, NumCells / FMath::Max(GridSizeX, 1) - 1); y++)
+		{
+			BakeJumpDistances(y, EGridDirection::East);
+			BakeJumpDistances(y, EGridDirection::West);
+		}
+		for (int32 x = FMath::Max(ChangedMin.X - 1, 0); x <= FMath::Min(ChangedMax.X + 1, GridSizeX - 1); x++)
+		{
+			BakeJumpDistances(x, EGridDirection::North);
+			BakeJumpDistances(x, EGridDirection::South);
+		}
+	}
+	// Rebuild only the clusters the changed cells can affect
+	ClusterGraph.RebuildRegion(*this, ChangedMin, ChangedMax);
+	// Repair the cached flow fields, only the cells whose path to the goal the changed cells can affect are searched again
+	for (auto& Pair : FlowFields)
+	{
+		Pair.Value->RepairRegion(ChangedMin, ChangedMax);
+	}
+	// Move to the next version and record the changed cells, so paths found on an older version can check if they cross them
+	uint32 NewVersion = GridVersion.load(std::memory_order_relaxed) + 1;
+	if (RegionChanges.Num() >= MaxRegionChanges)
+	{
+		OldestTrackedVersion = RegionChanges[0].Version;
+		RegionChanges.RemoveAt(0, 1, false);
+	}
+	RegionChanges.Add(FGridRegionChange{ NewVersion, ChangedMin, ChangedMax });
+	GridVersion.store(NewVersion, std::memory_order_relaxed);
+}
+
+void AGrid::MarkRegionDirty(const FBox& WorldBounds)
+{
+	// Rebake only the cells covered by the box
+	FIntPoint MinIndex, MaxIndex;
+	if (GetCellRangeFromBox(WorldBounds, MinIndex, MaxIndex))
+	{
+		RebakeRegion(MinIndex, MaxIndex);
+	}
+}
+
+void AGrid::MarkActorDirty(AActor* Actor)
+{
+	if (Actor)
+	{
+		MarkRegionDirty(Actor->GetComponentsBoundingBox());
+	}
+}
+
+void AGrid::RegisterDynamicObstacle(AActor* Actor)
+{
+	if (!Actor || !Actor->GetRootComponent() || DynamicObstacles.Contains(Actor))
+	{
+		return;
+	}
+	// Remember the bounds of the actor, so the cells it leaves are rebaked when it moves, and listen to the movement of its root component
+	DynamicObstacles.Add(Actor, Actor->GetComponentsBoundingBox());
+	Actor->GetRootComponent()->TransformUpdated.AddUObject(this, &AGrid::OnDynamicObstacleMoved);
+}
+
+void AGrid::UnregisterDynamicObstacle(AActor* Actor)
+{
+	if (Actor && DynamicObstacles.Remove(Actor) > 0 && Actor->GetRootComponent())
+	{
+		Actor->GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+}
+
+uint32 AGrid::GetGridVersion() const
+{
+	return GridVersion.load(std::memory_order_relaxed);
+}
+
+bool AGrid::HasPathChangedSince(const TArray<int32>& Path, uint32 Version) const
+{
+	// Changes older than the oldest recorded one are unknown, including the grid being recreated, so assume the path changed
+	if (Version < OldestTrackedVersion)
+	{
+		return true;
+	}
+	// Check the cells of the path against the bounds of every change made after the input version
+	for (const FGridRegionChange& Change : RegionChanges)
+	{
+		if (Change.Version <= Version)
+		{
+			continue;
+		}
+		for (int32 Cell : Path)
+		{
+			int32 IndexX = GetCellX(Cell);
+			int32 IndexY = GetCellY(Cell);
+			if (IndexX >= Change.MinIndex.X && IndexX <= Change.MaxIndex.X && IndexY >= Change.MinIndex.Y && IndexY <= Change.MaxIndex.Y)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+FVector2D AGrid::GetGridWorldSize()
+{
+	// Calculate the value of GridWorldSize based on GridSizeX and GridSizeY
+	float NodeDiameter = NodeRadius * 2;
+	GridWorldSize.X = GridSizeX * NodeDiameter;
+	GridWorldSize.Y = GridSizeY * NodeDiameter;
+	return GridWorldSize;
+}
+
+bool AGrid::HasForcedNeighbor(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY) const
+{
+	// Diagonal move: a cell behind the move on either side is blocked while the cell diagonal to it is walkable
+	if (DirX != 0 && DirY != 0)
+	{
+		return (!IsWalkable(IndexX - DirX, IndexY) && IsWalkable(IndexX - DirX, IndexY + DirY)) || (!IsWalkable(IndexX, IndexY - DirY) && IsWalkable(IndexX + DirX, IndexY - DirY));
+	}
+	// Straight move: a cell beside the move is blocked while the cell ahead of it is walkable
+	if (DirX != 0)
+	{
+		return (!IsWalkable(IndexX, IndexY + 1) && IsWalkable(IndexX + DirX, IndexY + 1)) || (!IsWalkable(IndexX, IndexY - 1) && IsWalkable(IndexX + DirX, IndexY - 1));
+	}
+	return (!IsWalkable(IndexX + 1, IndexY) && IsWalkable(IndexX + 1, IndexY + DirY)) || (!IsWalkable(IndexX - 1, IndexY) && IsWalkable(IndexX - 1, IndexY + DirY));
+}
+
+int32 AGrid::GetJumpDistance(int32 CellIndex, EGridDirection Direction) const
+{
+	return JumpDistances[CellIndex * (int32)EGridDirection::Num + (int32)Direction];
+}
+
+const FGridClusterGraph& AGrid::GetClusterGraph() const
+{
+	return ClusterGraph;
+}
+
+FPathQueryContextPool& AGrid::GetQueryContextPool()
+{
+	return QueryContextPool;
+}
+
+FPathCache& AGrid::GetPathCache()
+{
+	return PathCache;
+}
+
+TSharedPtr<const FGridFlowField> AGrid::GetFlowField(int32 GoalCell)
+{
+	if (GoalCell < 0 || GoalCell >= NumCells)
+	{
+		return nullptr;
+	}
+	// Move the goal to the most recently used end, and build its field if it isn't cached
+	if (TSharedPtr<FGridFlowField>* CachedField = FlowFields.Find(GoalCell))
+	{
+		FlowFieldGoals.Remove(GoalCell);
+		FlowFieldGoals.Add(GoalCell);
+		return *CachedField;
+	}
+	TSharedPtr<FGridFlowField> NewField = MakeShared<FGridFlowField>();
+	double StartTime = FPlatformTime::Seconds();
+	NewField->Build(*this, GoalCell);
+	UE_LOG(LogTemp, Log, TEXT("Flow field to cell %i built in %f milliseconds (%i cells searched)"), GoalCell, (FPlatformTime::Seconds() - StartTime) * 1000.0, NewField->GetNumSearched());
+	FlowFields.Add(GoalCell, NewField);
+	FlowFieldGoals.Add(GoalCell);
+	// Remove the least recently used fields above the cap
+	while (FlowFieldGoals.Num() > FMath::Max(MaxFlowFields, 1))
+	{
+		FlowFields.Remove(FlowFieldGoals[0]);
+		FlowFieldGoals.RemoveAt(0, 1, false);
+	}
+	return NewField;
+}
+
+FVector AGrid::GetFlowDirection(int32 GoalCell, FVector WorldLocation)
+{
+	TSharedPtr<const FGridFlowField> FlowField = GetFlowField(GoalCell);
+	int32 CellIndex = CellFromLocation(WorldLocation);
+	if (!FlowField.IsValid() || CellIndex == INDEX_NONE)
+	{
+		return FVector::ZeroVector;
+	}
+	// Cell X and Y indices grow along the world X and Y axes
+	FVector2D Direction = FlowField->GetDirection(CellIndex);
+	return FVector(Direction.X, Direction.Y, 0.0f);
+}
+
+FRWLock& AGrid::GetCellDataLock() const
+{
+	return CellDataLock;
+}
+
+bool AGrid::CanUseJumpPointSearch() const
+{
+	return !JumpDistances.IsEmpty() && HasUniformCellCosts();
+}
+
+void AGrid::AddStreamingSource(AActor* Actor)
+{
+	if (Actor && !StreamingSources.Contains(Actor))
+	{
+		StreamingSources.Add(Actor);
+		// Bake the tiles around the source without waiting for the next update
+		if (bTileStreamingActive)
+		{
+			UpdateStreaming();
+		}
+	}
+}
+
+void AGrid::RemoveStreamingSource(AActor* Actor)
+{
+	StreamingSources.Remove(Actor);
+}
+
+void AGrid::RequestTile(int32 TileIndex)
+{
+	if (!StreamingTiles.IsValidIndex(TileIndex))
+	{
+		return;
+	}
+	FGridStreamingTile& Tile = StreamingTiles[TileIndex];
+	// Resident tiles are moved to the back of the least recently used list, so they are unloaded last
+	if (Tile.State == ETileState::Resident)
+	{
+		ResidentTiles.Remove(TileIndex);
+		ResidentTiles.Add(TileIndex);
+		return;
+	}
+	if (Tile.State == ETileState::Loading)
+	{
+		return;
+	}
+	Tile.State = ETileState::Loading;
+	// Capture the layout of the tile, the worker thread doesn't read the actor transform
+	FIntPoint TileMin, TileMax;
+	GetTileBounds(TileIndex, TileMin, TileMax);
+	uint32 BakeId = PublishedBakeId;
+	FVector BottomLeftLocation = GetBottomLeftLocation();
+	float CellZ = GetActorLocation().Z;
+	float CellRadius = NodeRadius;
+	FCellTraceSettings TraceSettings = CaptureCellTraceSettings();
+	// Trace the cells of the tile on a worker task like the tiles of CreateGrid, only using the captured values, then publish them on the game thread
+	TileBakeTasks.RemoveAll([](const UE::Tasks::FTask& Task) { return Task.IsCompleted(); });
+	TWeakObjectPtr<AGrid> WeakThis(this);
+	TileBakeTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, BakeId, TileIndex, TileMin, TileMax, BottomLeftLocation, CellZ, CellRadius, TraceSettings = MoveTemp(TraceSettings)]()
+	{
+		PATHFINDING_SCOPE(STAT_PathfindingTileBake);
+		// The tile stays loading if the world was torn down, the grid is being destroyed with it
+		UWorld* World = TraceSettings.World.Get();
+		if (!World)
+		{
+			return;
+		}
+		TSharedRef<FGridTileBakeResult, ESPMode::ThreadSafe> Result = MakeShared<FGridTileBakeResult, ESPMode::ThreadSafe>();
+		Result->BakeId = BakeId;
+		Result->TileIndex = TileIndex;
+		int32 NumTileCells = (TileMax.X - TileMin.X + 1) * (TileMax.Y - TileMin.Y + 1);
+		Result->Walkable.SetNumUninitialized(NumTileCells);
+		Result->CellHeights.SetNumUninitialized(NumTileCells);
+		Result->CellCosts.SetNumUninitialized(NumTileCells);
+		int32 TileCell = 0;
+		for (int32 y = TileMin.Y; y <= TileMax.Y; y++)
+		{
+			for (int32 x = TileMin.X; x <= TileMax.X; x++, TileCell++)
+			{
+				FVector CellLocation = BottomLeftLocation + FVector(x * CellRadius * 2 + CellRadius, y * CellRadius * 2 + CellRadius, CellZ);
+				Result->Walkable[TileCell] = TraceCellWalkable(*World, CellLocation, TraceSettings, Result->CellHeights[TileCell], Result->CellCosts[TileCell]);
+			}
+		}
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Result]()
+		{
+			if (AGrid* Grid = WeakThis.Get())
+			{
+				Grid->PublishTile(*Result);
+			}
+		});
+	}));
+}
+
+void AGrid::RequestTilesForCells(TArrayView<const int32> Cells)
+{
+	if (!bTileStreamingActive)
+	{
+		return;
+	}
+	// Consecutive cells of a path are mostly in the same tile, so only request a tile when the tile changes
+	int32 LastTileIndex = INDEX_NONE;
+	for (int32 Cell : Cells)
+	{
+		int32 TileIndex = GetTileIndex(Cell);
+		if (TileIndex != LastTileIndex && StreamingTiles.IsValidIndex(TileIndex) && StreamingTiles[TileIndex].State == ETileState::Unloaded)
+		{
+			RequestTile(TileIndex);
+		}
+		LastTileIndex = TileIndex;
+	}
+}
+
+int32 AGrid::GetTileIndex(int32 CellIndex) const
+{
+	if (!bTileStreamingActive)
+	{
+		return INDEX_NONE;
+	}
+	return (GetCellY(CellIndex) / TileCellSize) * NumTilesX + GetCellX(CellIndex) / TileCellSize;
+}
+
+bool AGrid::IsTileResident(int32 TileIndex) const
+{
+	return StreamingTiles.IsValidIndex(TileIndex) && StreamingTiles[TileIndex].State == ETileState::Resident;
+}
+
+bool AGrid::IsCellResident(int32 CellIndex) const
+{
+	return !bTileStreamingActive || IsTileResident(GetTileIndex(CellIndex));
+}
+
+int32 AGrid::GetNumResidentTiles() const
+{
+	return ResidentTiles.Num();
+}
+
+void AGrid::GetTileBounds(int32 TileIndex, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+	OutMin = FIntPoint((TileIndex % NumTilesX) * TileCellSize, (TileIndex / NumTilesX) * TileCellSize);
+	OutMax = FIntPoint(FMath::Min(OutMin.X + TileCellSize, GridSizeX) - 1, FMath::Min(OutMin.Y + TileCellSize, NumCells / FMath::Max(GridSizeX, 1)) - 1);
+}
+
+void AGrid::PublishTile(FGridTileBakeResult& Result)
+{
+	PATHFINDING_SCOPE(STAT_PathfindingGridPublish);
+	// Discard the tile if the grid was created again since it was requested, or a new bake is running
+	if (Result.BakeId != PublishedBakeId || PublishedBakeId != LatestBakeId || !StreamingTiles.IsValidIndex(Result.TileIndex) || StreamingTiles[Result.TileIndex].State != ETileState::Loading)
+	{
+		return;
+	}
+	FIntPoint TileMin, TileMax;
+	GetTileBounds(Result.TileIndex, TileMin, TileMax);
+	FIntPoint ChangedMin(MAX_int32, MAX_int32);
+	FIntPoint ChangedMax(INDEX_NONE, INDEX_NONE);
+	{
+		// Hold the cell data lock for writing, so asynchronous searches don't read the cells of the tile while they are replaced
+		FWriteScopeLock CellDataWriteLock(CellDataLock);
+		FGridStreamingTile& Tile = StreamingTiles[Result.TileIndex];
+		Tile.State = ETileState::Resident;
+		Tile.CellHeights = MoveTemp(Result.CellHeights);
+		int32 TileCell = 0;
+		for (int32 y = TileMin.Y; y <= TileMax.Y; y++)
+		{
+			for (int32 x = TileMin.X; x <= TileMax.X; x++, TileCell++)
+			{
+				// Cells whose baked state matches the unknown cell state don't change, so paths crossing them stay valid
+				if (SetCellState(GetCellIndex(x, y), Result.Walkable[TileCell] != 0, Result.CellCosts[TileCell]))
+				{
+					ChangedMin = FIntPoint(FMath::Min(ChangedMin.X, x), FMath::Min(ChangedMin.Y, y));
+					ChangedMax = FIntPoint(FMath::Max(ChangedMax.X, x), FMath::Max(ChangedMax.Y, y));
+				}
+			}
+		}
+		if (ChangedMax.X != INDEX_NONE)
+		{
+			CommitRegionChange(ChangedMin, ChangedMax);
+		}
+	}
+	ResidentTiles.Add(Result.TileIndex);
+	if (ChangedMax.X != INDEX_NONE)
+	{
+		OnGridRegionChanged.Broadcast(ChangedMin, ChangedMax);
+	}
+	// Unload the least recently used tiles above the residency budget
+	while (ResidentTiles.Num() > FMath::Max(MaxResidentTiles, 1))
+	{
+		UnloadTile(ResidentTiles[0]);
+	}
+}
+
+void AGrid::UnloadTile(int32 TileIndex)
+{
+	if (!IsTileResident(TileIndex))
+	{
+		return;
+	}
+	ResidentTiles.Remove(TileIndex);
+	FIntPoint TileMin, TileMax;
+	GetTileBounds(TileIndex, TileMin, TileMax);
+	FIntPoint ChangedMin(MAX_int32, MAX_int32);
+	FIntPoint ChangedMax(INDEX_NONE, INDEX_NONE);
+	uint8 Cost = FMath::Max<uint8>(UnknownCellCost, 1);
+	{
+		// Hold the cell data lock for writing, so asynchronous searches don't read the cells of the tile while they are replaced
+		FWriteScopeLock CellDataWriteLock(CellDataLock);
+		FGridStreamingTile& Tile = StreamingTiles[TileIndex];
+		Tile.State = ETileState::Unloaded;
+		Tile.CellHeights.Empty();
+		for (int32 y = TileMin.Y; y <= TileMax.Y; y++)
+		{
+			for (int32 x = TileMin.X; x <= TileMax.X; x++)
+			{
+				if (SetCellState(GetCellIndex(x, y), bUnknownCellsWalkable, Cost))
+				{
+					ChangedMin = FIntPoint(FMath::Min(ChangedMin.X, x), FMath::Min(ChangedMin.Y, y));
+					ChangedMax = FIntPoint(FMath::Max(ChangedMax.X, x), FMath::Max(ChangedMax.Y, y));
+				}
+			}
+		}
+		if (ChangedMax.X == INDEX_NONE)
+		{
+			return;
+		}
+		CommitRegionChange(ChangedMin, ChangedMax);
+	}
+	OnGridRegionChanged.Broadcast(ChangedMin, ChangedMax);
+}
+
+void AGrid::UpdateStreaming()
+{
+	// Forget the sources that were destroyed
+	StreamingSources.RemoveAll([](const TWeakObjectPtr<AActor>& Source) { return !Source.IsValid(); });
+	int32 NumTilesY = StreamingTiles.Num() / FMath::Max(NumTilesX, 1);
+	for (const TWeakObjectPtr<AActor>& Source : StreamingSources)
+	{
+		int32 SourceCell = CellFromLocation(Source->GetActorLocation());
+		if (SourceCell == INDEX_NONE)
+		{
+			continue;
+		}
+		// Request every tile in the radius around the tile of the source, which also marks the resident ones as recently used
+		int32 SourceTileX = GetCellX(SourceCell) / TileCellSize;
+		int32 SourceTileY = GetCellY(SourceCell) / TileCellSize;
+		for (int32 TileY = FMath::Max(SourceTileY - StreamingRadiusTiles, 0); TileY <= FMath::Min(SourceTileY + StreamingRadiusTiles, NumTilesY - 1); TileY++)
+		{
+			for (int32 TileX = FMath::Max(SourceTileX - StreamingRadiusTiles, 0); TileX <= FMath::Min(SourceTileX + StreamingRadiusTiles, NumTilesX - 1); TileX++)
+			{
+				RequestTile(TileY * NumTilesX + TileX);
+			}
+		}
+	}
+}
+
+bool AGrid::GetCellRangeFromBox(const FBox& WorldBounds, FIntPoint& OutMin, FIntPoint& OutMax) const
+{
+	if (!WorldBounds.IsValid || NumCells == 0)
+	{
+		return false;
+	}
+	// Get the indices of the cells whose footprint overlaps the box in X and Y, each cell covers NodeDiameter from the bottom left corner
+	float NodeDiameter = NodeRadius * 2;
+	FVector BottomLeftLocation = GetBottomLeftLocation();
+	int32 NumRows = NumCells / GridSizeX;
+	OutMin.X = FMath::Max(FMath::FloorToInt((WorldBounds.Min.X - BottomLeftLocation.X) / NodeDiameter), 0);
+	OutMin.Y = FMath::Max(FMath::FloorToInt((WorldBounds.Min.Y - BottomLeftLocation.Y) / NodeDiameter), 0);
+	OutMax.X = FMath::Min(FMath::FloorToInt((WorldBounds.Max.X - BottomLeftLocation.X) / NodeDiameter), GridSizeX - 1);
+	OutMax.Y = FMath::Min(FMath::FloorToInt((WorldBounds.Max.Y - BottomLeftLocation.Y) / NodeDiameter), NumRows - 1);
+	return OutMin.X <= OutMax.X && OutMin.Y <= OutMax.Y;
+}
+
+void AGrid::OnDynamicObstacleMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	AActor* Actor = UpdatedComponent->GetOwner();
+	FBox* LastBounds = DynamicObstacles.Find(Actor);
+	if (!LastBounds)
+	{
+		return;
+	}
+	// Rebake the cells the actor left and the cells it entered, as one region if they overlap
+	FBox NewBounds = Actor->GetComponentsBoundingBox();
+	if (LastBounds->Intersect(NewBounds))
+	{
+		MarkRegionDirty(*LastBounds + NewBounds);
+	}
+	else
+	{
+		MarkRegionDirty(*LastBounds);
+		MarkRegionDirty(NewBounds);
+	}
+	// Find again, listeners of the rebake could have registered obstacles and changed the map
+	if (FBox* Bounds = DynamicObstacles.Find(Actor))
+	{
+		*Bounds = NewBounds;
+	}
+}
+
+FVector AGrid::GetBottomLeftLocation() const
+{
+	return GetActorLocation() + FVector(-1.f * GridWorldSize.X / 2.0f, -1.f * GridWorldSize.Y / 2.0f, GetActorLocation().Z);
+}
+
+AGrid::FCellCostRules AGrid::CaptureCellCostRules() const
+{
+	FCellCostRules Rules;
+	Rules.DefaultCost = FMath::Max<uint8>(DefaultCellCost, 1);
+	for (const auto& Pair : PhysicalMaterialCosts)
+	{
+		if (Pair.Key)
+		{
+			Rules.MaterialCosts.Add(Pair.Key, FMath::Max<uint8>(Pair.Value, 1));
+		}
+	}
+	// Volume bounds are read now, so volumes moved later only change the costs of cells baked after they moved
+	for (const FGridCostVolume& CostVolume : CostVolumes)
+	{
+		if (CostVolume.Volume)
+		{
+			Rules.VolumeCosts.Add(TPair<FBox, uint8>(CostVolume.Volume->GetComponentsBoundingBox(), FMath::Max<uint8>(CostVolume.Cost, 1)));
+		}
+	}
+	return Rules;
+}
+
+AGrid::FCellTraceSettings AGrid::CaptureCellTraceSettings() const
+{
+	FCellTraceSettings Settings;
+	Settings.World = GetWorld();
+	Settings.IgnoredActorId = GetUniqueID();
+	Settings.GroundDetection = GroundDetection;
+	Settings.NodeRadius = NodeRadius;
+	Settings.MaxAllowedHeight = MaxAllowedHeight;
+	Settings.CostRules = CaptureCellCostRules();
+	return Settings;
+}
+
+bool AGrid::TraceCellWalkable(UWorld& World, const FVector& CellLocation, const FCellTraceSettings& Settings, float& OutHeight, uint8& OutCost)
+{
+	const FCellCostRules& CostRules = Settings.CostRules;
+	// Use line trace by channel starting from the cell center and ending below it with distance determined by GroundDetection, to check if there is ground under the cell or not
+	// The physical material of the ground is returned to find the cost of the cell
+	FHitResult GroundResult;
+	FVector GroundEndLocation = CellLocation + FVector(0.0f, 0.0f, 1.0f) * -1 * Settings.GroundDetection;
+	FCollisionQueryParams GroundParams(SCENE_QUERY_STAT(GridGroundTrace), false);
+	GroundParams.bReturnPhysicalMaterial = true;
+	bool bGround = World.LineTraceSingleByChannel(GroundResult, CellLocation, GroundEndLocation, ECollisionChannel::ECC_Camera, GroundParams, FCollisionResponseParams::DefaultResponseParam);
+	// Store the height of the found ground, or the cell height if no ground was found
+	OutHeight = bGround ? GroundResult.ImpactPoint.Z : CellLocation.Z;
+	// Cost of the ground material if it has one, overridden by the highest cost of the volumes covering the cell center
+	OutCost = CostRules.DefaultCost;
+	if (const uint8* MaterialCost = bGround ? CostRules.MaterialCosts.Find(GroundResult.PhysMaterial.Get()) : nullptr)
+	{
+		OutCost = *MaterialCost;
+	}
+	uint8 VolumeCost = 0;
+	for (const TPair<FBox, uint8>& Volume : CostRules.VolumeCosts)
+	{
+		if (Volume.Key.IsInsideXY(CellLocation))
+		{
+			VolumeCost = FMath::Max(VolumeCost, Volume.Value);
+		}
+	}
+	if (VolumeCost > 0)
+	{
+		OutCost = VolumeCost;
+	}
+	if (!bGround)
+	{
+		return false;
+	}
+	// Use a box overlap with half size of radius above the cell, with max allowable height added to the radius, to check if there is an obstacle on the cell or not
+	// Overlap tests only read the physics scene, so cells can be traced from worker threads
+	FVector BoxLocation = CellLocation + FVector(0.0f, 0.0f, 1.0f) * (Settings.NodeRadius + Settings.MaxAllowedHeight);
+	FVector HalfSize = UKismetMathLibrary::Vector_One() * Settings.NodeRadius;
+	FCollisionQueryParams ObstacleParams(SCENE_QUERY_STAT(GridObstacleTrace), false);
+	ObstacleParams.AddIgnoredActor(Settings.IgnoredActorId);
+	bool bObstacle = World.OverlapBlockingTestByChannel(BoxLocation, FQuat::Identity, UEngineTypes::ConvertToCollisionChannel(ETraceTypeQuery::TraceTypeQuery2), FCollisionShape::MakeBox(HalfSize), ObstacleParams);
+	return !bObstacle;
+}
+
+void AGrid::BakeJumpDistances(int32 LineIndex, EGridDirection Direction)
+{
+	// Get the step of the direction, and the number of cells on the line it moves along
+	int32 DirX = Direction == EGridDirection::East ? 1 : (Direction == EGridDirection::West ? -1 : 0);
+	int32 DirY = Direction == EGridDirection::North ? 1 : (Direction == EGridDirection::South ? -1 : 0);
+	int32 LineLength = DirX != 0 ? GridSizeX : NumCells / FMath::Max(GridSizeX, 1);
+	// Walk the line against the direction, so the jump distance of the next cell is known when each cell is reached
+	int32 Distance = 0;
+	for (int32 Step = 0; Step < LineLength; Step++)
+	{
+		int32 Position = (DirX + DirY > 0) ? LineLength - 1 - Step : Step;
+		int32 IndexX = DirX != 0 ? Position : LineIndex;
+		int32 IndexY = DirX != 0 ? LineIndex : Position;
+		// Next cell blocked: no step possible, next cell has a forced neighbor: it's a jump point 1 step away, else extend the distance of the next cell by 1 step
+		if (!IsWalkable(IndexX + DirX, IndexY + DirY))
+		{
+			Distance = 0;
+		}
+		else if (HasForcedNeighbor(IndexX + DirX, IndexY + DirY, DirX, DirY))
+		{
+			Distance = 1;
+		}
+		else
+		{
+			Distance = Distance > 0 ? Distance + 1 : Distance - 1;
+		}
+		JumpDistances[GetCellIndex(IndexX, IndexY) * (int32)EGridDirection::Num + (int32)Direction] = Distance;
+	}
+}
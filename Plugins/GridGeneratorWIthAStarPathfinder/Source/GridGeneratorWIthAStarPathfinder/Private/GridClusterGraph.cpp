@@ -0,0 +1,390 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridClusterGraph.h"
+#include "Grid.h"
+#include "OctileDistance.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+void FGridClusterGraph::Build(const AGrid& Grid, int32 InClusterSize)
+{
+	// Calculate the number of clusters needed to cover all baked cells
+	ClusterSize = FMath::Max(InClusterSize, 2);
+	GridSizeX = Grid.GridSizeX;
+	GridSizeY = Grid.GetNumCells() / FMath::Max(GridSizeX, 1);
+	NumClustersX = FMath::DivideAndRoundUp(GridSizeX, ClusterSize);
+	NumClustersY = FMath::DivideAndRoundUp(GridSizeY, ClusterSize);
+	Clusters.Reset();
+	Clusters.SetNum(NumClustersX * NumClustersY);
+	// Clusters only write their own entrances and costs, so they can be built in parallel
+	ParallelFor(Clusters.Num(), [this, &Grid](int32 ClusterIndex)
+	{
+		BuildCluster(Grid, ClusterIndex);
+	});
+}
+
+void FGridClusterGraph::RebuildRegion(const AGrid& Grid, FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	if (!IsBuilt())
+	{
+		return;
+	}
+	// Entrances depend on the cells on both sides of a border, so grow the region by 1 cell to include clusters sharing a border with the changed cells
+	int32 MinClusterX = FMath::Clamp(MinIndex.X - 1, 0, GridSizeX - 1) / ClusterSize;
+	int32 MinClusterY = FMath::Clamp(MinIndex.Y - 1, 0, GridSizeY - 1) / ClusterSize;
+	int32 MaxClusterX = FMath::Clamp(MaxIndex.X + 1, 0, GridSizeX - 1) / ClusterSize;
+	int32 MaxClusterY = FMath::Clamp(MaxIndex.Y + 1, 0, GridSizeY - 1) / ClusterSize;
+	TArray<int32> ClusterIndices;
+	for (int32 ClusterY = MinClusterY; ClusterY <= MaxClusterY; ClusterY++)
+	{
+		for (int32 ClusterX = MinClusterX; ClusterX <= MaxClusterX; ClusterX++)
+		{
+			ClusterIndices.Add(ClusterY * NumClustersX + ClusterX);
+		}
+	}
+	ParallelFor(ClusterIndices.Num(), [this, &Grid, &ClusterIndices](int32 Index)
+	{
+		BuildCluster(Grid, ClusterIndices[Index]);
+	});
+}
+
+void FGridClusterGraph::Reset()
+{
+	Clusters.Empty();
+	ClusterSize = 0;
+	NumClustersX = 0;
+	NumClustersY = 0;
+}
+
+bool FGridClusterGraph::IsBuilt() const
+{
+	return !Clusters.IsEmpty();
+}
+
+int32 FGridClusterGraph::GetClusterSize() const
+{
+	return ClusterSize;
+}
+
+bool FGridClusterGraph::FindPath(const AGrid& Grid, FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	OutPath.Reset();
+	int32 StartCluster = GetClusterIndex(StartCell);
+	int32 TargetCluster = GetClusterIndex(TargetCell);
+	const FCluster& Start = Clusters[StartCluster];
+	const FCluster& Target = Clusters[TargetCluster];
+	// Take all scratch memory of the query from the context arena
+	FPathQueryArena& Arena = Context.GetArena();
+	Arena.Reset();
+	FClusterSearch Search(Arena);
+	// Search the start cluster from the start cell to get its costs to the entrances of the cluster, and to the target if it's in the same cluster
+	SearchCluster(Grid, Search, StartCluster, StartCell, INDEX_NONE);
+	TArray<int32>& StartCosts = Arena.AllocateArray();
+	for (int32 EntranceCell : Start.EntranceCells)
+	{
+		StartCosts.Add(Search.Costs[GetLocalIndex(StartCluster, EntranceCell)]);
+	}
+	int32 DirectCost = StartCluster == TargetCluster ? Search.Costs[GetLocalIndex(StartCluster, TargetCell)] : MAX_int32;
+	// Search the target cluster from the target cell to get the costs of its entrances to the target, moves cost the same in both directions
+	SearchCluster(Grid, Search, TargetCluster, TargetCell, INDEX_NONE);
+	TArray<int32>& TargetCosts = Arena.AllocateArray();
+	for (int32 EntranceCell : Target.EntranceCells)
+	{
+		TargetCosts.Add(Search.Costs[GetLocalIndex(TargetCluster, EntranceCell)]);
+	}
+	// Search the entrances graph with A*, the nodes are cells so the records of the context are used directly
+	Context.BeginQuery(Grid.GetNumCells(), StartCell, TargetCell);
+	int32 HeuristicScale = Grid.GetMinCellCost();
+	Context.Visit(StartCell, 0, GetDistanceBetweenCells(StartCell, TargetCell) * HeuristicScale, INDEX_NONE);
+	FNodeHeap& OpenNodes = Context.GetOpenNodes();
+	OpenNodes.Add(StartCell, Context.Getf_cost(StartCell), Context.Geth_cost(StartCell));
+	bool bFoundTarget = false;
+	while (!OpenNodes.IsEmpty())
+	{
+		if (bCancelled != nullptr && bCancelled->load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+		int32 CurrentCell = OpenNodes.Pop();
+		Context.SetAnalyzed(CurrentCell);
+		if (CurrentCell == TargetCell)
+		{
+			bFoundTarget = true;
+			break;
+		}
+		// From the start cell: edges to the entrances of its cluster, and to the target if it's in the same cluster
+		if (CurrentCell == StartCell)
+		{
+			for (int32 EntranceIndex = 0; EntranceIndex < Start.EntranceCells.Num(); EntranceIndex++)
+			{
+				if (StartCosts[EntranceIndex] != MAX_int32)
+				{
+					VisitNode(Context, CurrentCell, Start.EntranceCells[EntranceIndex], StartCosts[EntranceIndex], HeuristicScale);
+				}
+			}
+			if (DirectCost != MAX_int32)
+			{
+				VisitNode(Context, CurrentCell, TargetCell, DirectCost, HeuristicScale);
+			}
+		}
+		// From an entrance: edges to its partner across the border, to the other entrances of its cluster, and to the target if it's in the same cluster
+		int32 ClusterIndex = GetClusterIndex(CurrentCell);
+		const FCluster& Cluster = Clusters[ClusterIndex];
+		int32 NumEntrances = Cluster.EntranceCells.Num();
+		for (int32 EntranceIndex = 0; EntranceIndex < NumEntrances; EntranceIndex++)
+		{
+			if (Cluster.EntranceCells[EntranceIndex] != CurrentCell)
+			{
+				continue;
+			}
+			int32 PartnerCell = Cluster.PartnerCells[EntranceIndex];
+			VisitNode(Context, CurrentCell, PartnerCell, Grid.GetMoveCost(CurrentCell, PartnerCell, GetDistanceBetweenCells(CurrentCell, PartnerCell)), HeuristicScale);
+			for (int32 OtherIndex = 0; OtherIndex < NumEntrances; OtherIndex++)
+			{
+				int32 Cost = Cluster.Costs[EntranceIndex * NumEntrances + OtherIndex];
+				if (OtherIndex != EntranceIndex && Cost != MAX_int32)
+				{
+					VisitNode(Context, CurrentCell, Cluster.EntranceCells[OtherIndex], Cost, HeuristicScale);
+				}
+			}
+			if (ClusterIndex == TargetCluster && TargetCosts[EntranceIndex] != MAX_int32)
+			{
+				VisitNode(Context, CurrentCell, TargetCell, TargetCosts[EntranceIndex], HeuristicScale);
+			}
+		}
+	}
+	if (!bFoundTarget)
+	{
+		return false;
+	}
+	// Retrace the abstract path from the target to the start
+	TArray<int32>& AbstractPath = Arena.AllocateArray();
+	for (int32 Cell = TargetCell; Cell != INDEX_NONE; Cell = Context.GetParentCell(Cell))
+	{
+		AbstractPath.Add(Cell);
+	}
+	Algo::Reverse(AbstractPath);
+	// Refine each step of the abstract path, steps between clusters are single moves across a border, steps inside a cluster are searched within its bounds
+	OutPath.Add(StartCell);
+	for (int32 Step = 1; Step < AbstractPath.Num(); Step++)
+	{
+		int32 FromCell = AbstractPath[Step - 1];
+		int32 ToCell = AbstractPath[Step];
+		int32 ClusterIndex = GetClusterIndex(FromCell);
+		if (ClusterIndex != GetClusterIndex(ToCell))
+		{
+			OutPath.Add(ToCell);
+			continue;
+		}
+		SearchCluster(Grid, Search, ClusterIndex, FromCell, ToCell);
+		AppendClusterPath(Search, ClusterIndex, FromCell, ToCell, OutPath);
+	}
+	return true;
+}
+
+void FGridClusterGraph::BuildCluster(const AGrid& Grid, int32 ClusterIndex)
+{
+	// Find the entrances on the 4 borders of the cluster, borders on the grid edge have none
+	FCluster& Cluster = Clusters[ClusterIndex];
+	Cluster.EntranceCells.Reset();
+	Cluster.PartnerCells.Reset();
+	AddBorderEntrances(Grid, Cluster, ClusterIndex, 1, 0);
+	AddBorderEntrances(Grid, Cluster, ClusterIndex, -1, 0);
+	AddBorderEntrances(Grid, Cluster, ClusterIndex, 0, 1);
+	AddBorderEntrances(Grid, Cluster, ClusterIndex, 0, -1);
+	// Search the cluster from each entrance to get its cost to all other entrances
+	int32 NumEntrances = Cluster.EntranceCells.Num();
+	Cluster.Costs.SetNumUninitialized(NumEntrances * NumEntrances);
+	FPathQueryArena Arena;
+	FClusterSearch Search(Arena);
+	for (int32 EntranceIndex = 0; EntranceIndex < NumEntrances; EntranceIndex++)
+	{
+		SearchCluster(Grid, Search, ClusterIndex, Cluster.EntranceCells[EntranceIndex], INDEX_NONE);
+		for (int32 OtherIndex = 0; OtherIndex < NumEntrances; OtherIndex++)
+		{
+			Cluster.Costs[EntranceIndex * NumEntrances + OtherIndex] = Search.Costs[GetLocalIndex(ClusterIndex, Cluster.EntranceCells[OtherIndex])];
+		}
+	}
+}
+
+void FGridClusterGraph::AddBorderEntrances(const AGrid& Grid, FCluster& Cluster, int32 ClusterIndex, int32 DirX, int32 DirY) const
+{
+	int32 MinX, MinY, MaxX, MaxY;
+	GetClusterBounds(ClusterIndex, MinX, MinY, MaxX, MaxY);
+	// Get the line of cells of the cluster on the border, and the range along it
+	int32 BorderX = DirX > 0 ? MaxX : MinX;
+	int32 BorderY = DirY > 0 ? MaxY : MinY;
+	int32 RangeMin = DirX != 0 ? MinY : MinX;
+	int32 RangeMax = DirX != 0 ? MaxY : MaxX;
+	// Find the runs of positions where the cell of the cluster and the cell across the border are both walkable
+	// Both clusters sharing the border find the same runs, so their entrances are always paired
+	int32 RunStart = INDEX_NONE;
+	for (int32 Position = RangeMin; Position <= RangeMax + 1; Position++)
+	{
+		int32 IndexX = DirX != 0 ? BorderX : Position;
+		int32 IndexY = DirX != 0 ? Position : BorderY;
+		bool bOpen = Position <= RangeMax && Grid.IsWalkable(IndexX, IndexY) && Grid.IsWalkable(IndexX + DirX, IndexY + DirY);
+		if (bOpen && RunStart == INDEX_NONE)
+		{
+			RunStart = Position;
+		}
+		else if (!bOpen && RunStart != INDEX_NONE)
+		{
+			// Add an entrance in the middle of a short run, or at both ends of a long one
+			int32 RunEnd = Position - 1;
+			int32 EntrancePositions[2] = { (RunStart + RunEnd) / 2, INDEX_NONE };
+			if (RunEnd - RunStart + 1 > MaxSingleEntranceLength)
+			{
+				EntrancePositions[0] = RunStart;
+				EntrancePositions[1] = RunEnd;
+			}
+			for (int32 EntrancePosition : EntrancePositions)
+			{
+				if (EntrancePosition != INDEX_NONE)
+				{
+					int32 EntranceX = DirX != 0 ? BorderX : EntrancePosition;
+					int32 EntranceY = DirX != 0 ? EntrancePosition : BorderY;
+					Cluster.EntranceCells.Add(Grid.GetCellIndex(EntranceX, EntranceY));
+					Cluster.PartnerCells.Add(Grid.GetCellIndex(EntranceX + DirX, EntranceY + DirY));
+				}
+			}
+			RunStart = INDEX_NONE;
+		}
+	}
+}
+
+int32 FGridClusterGraph::SearchCluster(const AGrid& Grid, FClusterSearch& Search, int32 ClusterIndex, int32 SourceCell, int32 TargetCell) const
+{
+	int32 MinX, MinY, MaxX, MaxY;
+	GetClusterBounds(ClusterIndex, MinX, MinY, MaxX, MaxY);
+	// Reset the scratch state for all cells of a full size cluster
+	int32 NumLocalCells = ClusterSize * ClusterSize;
+	Search.OpenNodes.Initialize(NumLocalCells);
+	Search.Costs.Init(MAX_int32, NumLocalCells);
+	Search.Parents.SetNumUninitialized(NumLocalCells);
+	// A* towards the target cell, or Dijkstra over the whole cluster if there is no target
+	int32 TargetLocal = TargetCell != INDEX_NONE ? GetLocalIndex(ClusterIndex, TargetCell) : INDEX_NONE;
+	int32 SourceLocal = GetLocalIndex(ClusterIndex, SourceCell);
+	int32 HeuristicScale = Grid.GetMinCellCost();
+	int32 SourceHeuristic = TargetCell != INDEX_NONE ? GetDistanceBetweenCells(SourceCell, TargetCell) * HeuristicScale : 0;
+	Search.Costs[SourceLocal] = 0;
+	Search.Parents[SourceLocal] = INDEX_NONE;
+	Search.OpenNodes.Add(SourceLocal, SourceHeuristic, SourceHeuristic);
+	while (!Search.OpenNodes.IsEmpty())
+	{
+		int32 CurrentLocal = Search.OpenNodes.Pop();
+		if (CurrentLocal == TargetLocal)
+		{
+			return Search.Costs[CurrentLocal];
+		}
+		int32 CurrentX = MinX + CurrentLocal % ClusterSize;
+		int32 CurrentY = MinY + CurrentLocal / ClusterSize;
+		int32 CurrentCell = Grid.GetCellIndex(CurrentX, CurrentY);
+		// Visit the walkable neighbor cells inside the cluster bounds, in the same order as the Grid neighbor cells
+		for (int32 y = -1; y <= 1; y++)
+		{
+			for (int32 x = -1; x <= 1; x++)
+			{
+				int32 IndexX = CurrentX + x;
+				int32 IndexY = CurrentY + y;
+				if ((x == 0 && y == 0) || IndexX < MinX || IndexX > MaxX || IndexY < MinY || IndexY > MaxY || !Grid.IsWalkable(IndexX, IndexY))
+				{
+					continue;
+				}
+				// Cells reached before and no longer in the open set are final
+				int32 NeighborLocal = (IndexY - MinY) * ClusterSize + (IndexX - MinX);
+				bool bInOpenNodes = Search.OpenNodes.Contains(NeighborLocal);
+				if (!bInOpenNodes && Search.Costs[NeighborLocal] != MAX_int32)
+				{
+					continue;
+				}
+				int32 NeighborCell = Grid.GetCellIndex(IndexX, IndexY);
+				int32 Cost = Search.Costs[CurrentLocal] + Grid.GetMoveCost(CurrentCell, NeighborCell, FOctileDistance::GetMoveCost(x, y));
+				if (!bInOpenNodes || Cost < Search.Costs[NeighborLocal])
+				{
+					int32 Heuristic = TargetCell != INDEX_NONE ? GetDistanceBetweenCells(NeighborCell, TargetCell) * HeuristicScale : 0;
+					Search.Costs[NeighborLocal] = Cost;
+					Search.Parents[NeighborLocal] = CurrentLocal;
+					if (!bInOpenNodes)
+					{
+						Search.OpenNodes.Add(NeighborLocal, Cost + Heuristic, Heuristic);
+					}
+					else
+					{
+						Search.OpenNodes.Update(NeighborLocal, Cost + Heuristic, Heuristic);
+					}
+				}
+			}
+		}
+	}
+	return MAX_int32;
+}
+
+void FGridClusterGraph::AppendClusterPath(const FClusterSearch& Search, int32 ClusterIndex, int32 SourceCell, int32 Cell, TArray<int32>& OutPath) const
+{
+	// Follow the parents from the input cell back to the source cell, then add the cells in order
+	int32 FirstAdded = OutPath.Num();
+	int32 SourceLocal = GetLocalIndex(ClusterIndex, SourceCell);
+	for (int32 Local = GetLocalIndex(ClusterIndex, Cell); Local != SourceLocal; Local = Search.Parents[Local])
+	{
+		OutPath.Add(GetCellFromLocalIndex(ClusterIndex, Local));
+	}
+	Algo::Reverse(OutPath.GetData() + FirstAdded, OutPath.Num() - FirstAdded);
+}
+
+void FGridClusterGraph::VisitNode(FPathQueryContext& Context, int32 FromCell, int32 Cell, int32 EdgeCost, int32 HeuristicScale) const
+{
+	if (Context.IsAnalyzed(Cell))
+	{
+		return;
+	}
+	// Same relaxation as the pathfinder, with the precomputed cost of the edge instead of the distance between the cells
+	FNodeHeap& OpenNodes = Context.GetOpenNodes();
+	int32 g_costNew = Context.Getg_cost(FromCell) + EdgeCost;
+	bool bInOpenNodes = OpenNodes.Contains(Cell);
+	if (!bInOpenNodes || g_costNew < Context.Getg_cost(Cell))
+	{
+		Context.Visit(Cell, g_costNew, GetDistanceBetweenCells(Cell, Context.GetTargetCell()) * HeuristicScale, FromCell);
+		if (!bInOpenNodes)
+		{
+			OpenNodes.Add(Cell, Context.Getf_cost(Cell), Context.Geth_cost(Cell));
+		}
+		else
+		{
+			OpenNodes.Update(Cell, Context.Getf_cost(Cell), Context.Geth_cost(Cell));
+		}
+	}
+}
+
+int32 FGridClusterGraph::GetClusterIndex(int32 CellIndex) const
+{
+	return (CellIndex / GridSizeX / ClusterSize) * NumClustersX + (CellIndex % GridSizeX) / ClusterSize;
+}
+
+void FGridClusterGraph::GetClusterBounds(int32 ClusterIndex, int32& MinX, int32& MinY, int32& MaxX, int32& MaxY) const
+{
+	MinX = (ClusterIndex % NumClustersX) * ClusterSize;
+	MinY = (ClusterIndex / NumClustersX) * ClusterSize;
+	MaxX = FMath::Min(MinX + ClusterSize, GridSizeX) - 1;
+	MaxY = FMath::Min(MinY + ClusterSize, GridSizeY) - 1;
+}
+
+int32 FGridClusterGraph::GetLocalIndex(int32 ClusterIndex, int32 CellIndex) const
+{
+	int32 MinX = (ClusterIndex % NumClustersX) * ClusterSize;
+	int32 MinY = (ClusterIndex / NumClustersX) * ClusterSize;
+	return (CellIndex / GridSizeX - MinY) * ClusterSize + (CellIndex % GridSizeX - MinX);
+}
+
+int32 FGridClusterGraph::GetCellFromLocalIndex(int32 ClusterIndex, int32 LocalIndex) const
+{
+	int32 IndexX = (ClusterIndex % NumClustersX) * ClusterSize + LocalIndex % ClusterSize;
+	int32 IndexY = (ClusterIndex / NumClustersX) * ClusterSize + LocalIndex / ClusterSize;
+	return IndexY * GridSizeX + IndexX;
+}
+
+int32 FGridClusterGraph::GetDistanceBetweenCells(int32 StartCell, int32 EndCell) const
+{
+	return FOctileDistance::Get(EndCell % GridSizeX - StartCell % GridSizeX, EndCell / GridSizeX - StartCell / GridSizeX);
+}
@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GridFlowField.h"
+#include "Grid.h"
+#include "OctileDistance.h"
+#include "Async/ParallelFor.h"
+#include "PathfindingStats.h"
+
+void FGridFlowField::Build(const AGrid& InGrid, int32 InGoalCell)
+{
+	PATHFINDING_SCOPE(STAT_PathfindingFlowField);
+	Grid = &InGrid;
+	GoalCell = InGoalCell;
+	GridSizeX = Grid->GridSizeX;
+	GridSizeY = Grid->GetNumCells() / FMath::Max(GridSizeX, 1);
+	// All cells start unreachable, then the search spreads from the goal to every cell that can reach it
+	int32 NumCells = Grid->GetNumCells();
+	Costs.Init(MAX_int32, NumCells);
+	Directions.Init(NoDirection, NumCells);
+	OpenNodes.Initialize(NumCells);
+	NumSearched = 0;
+	if (Grid->IsCellWalkable(GoalCell))
+	{
+		LowerCost(GoalCell, 0);
+	}
+	FIntPoint ChangedMin(MAX_int32, MAX_int32);
+	FIntPoint ChangedMax(INDEX_NONE, INDEX_NONE);
+	SearchIntegration(ChangedMin, ChangedMax);
+	UpdateDirections(FIntPoint(0, 0), FIntPoint(GridSizeX - 1, GridSizeY - 1));
+}
+
+void FGridFlowField::RepairRegion(FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	PATHFINDING_SCOPE(STAT_PathfindingFlowField);
+	if (Grid == nullptr || Costs.Num() != Grid->GetNumCells())
+	{
+		return;
+	}
+	NumSearched = 0;
+	// Moves into and out of the changed cells changed cost, so the changed cells and their neighbors are affected
+	TBitArray<> bAffected(false, Costs.Num());
+	AffectedCells.Reset();
+	FIntPoint ChangedMin(FMath::Max(MinIndex.X - 1, 0), FMath::Max(MinIndex.Y - 1, 0));
+	FIntPoint ChangedMax(FMath::Min(MaxIndex.X + 1, GridSizeX - 1), FMath::Min(MaxIndex.Y + 1, GridSizeY - 1));
+	for (int32 y = ChangedMin.Y; y <= ChangedMax.Y; y++)
+	{
+		for (int32 x = ChangedMin.X; x <= ChangedMax.X; x++)
+		{
+			int32 CellIndex = Grid->GetCellIndex(x, y);
+			bAffected[CellIndex] = true;
+			AffectedCells.Add(CellIndex);
+		}
+	}
+	// Cells whose path to the goal goes through an affected cell are affected too, find them by following the directions backwards
+	for (int32 AffectedIndex = 0; AffectedIndex < AffectedCells.Num(); AffectedIndex++)
+	{
+		int32 AffectedCell = AffectedCells[AffectedIndex];
+		Grid->ForEachNeighborCell(AffectedCell, [this, AffectedCell, &bAffected](int32 Neighbor)
+		{
+			if (!bAffected[Neighbor] && GetNextCell(Neighbor) == AffectedCell)
+			{
+				bAffected[Neighbor] = true;
+				AffectedCells.Add(Neighbor);
+			}
+		});
+	}
+	// Reset the affected cells to unreachable
+	OpenNodes.Initialize(Costs.Num());
+	for (int32 AffectedCell : AffectedCells)
+	{
+		Costs[AffectedCell] = MAX_int32;
+		Directions[AffectedCell] = NoDirection;
+		ChangedMin = FIntPoint(FMath::Min(ChangedMin.X, Grid->GetCellX(AffectedCell)), FMath::Min(ChangedMin.Y, Grid->GetCellY(AffectedCell)));
+		ChangedMax = FIntPoint(FMath::Max(ChangedMax.X, Grid->GetCellX(AffectedCell)), FMath::Max(ChangedMax.Y, Grid->GetCellY(AffectedCell)));
+	}
+	// Start the search from the affected cells, each with its cheapest cost through an unaffected neighbor, whose cost is still valid
+	for (int32 AffectedCell : AffectedCells)
+	{
+		if (!Grid->IsCellWalkable(AffectedCell))
+		{
+			continue;
+		}
+		if (AffectedCell == GoalCell)
+		{
+			LowerCost(AffectedCell, 0);
+			continue;
+		}
+		int32 BestCost = MAX_int32;
+		uint8 NeighborMask = Grid->GetNeighborMask(AffectedCell);
+		for (int32 Direction = 0; Direction < 8; Direction++)
+		{
+			int32 Neighbor = AffectedCell + Grid->GetNeighborOffset(Direction);
+			if (!(NeighborMask & (1 << Direction)) || bAffected[Neighbor] || Costs[Neighbor] == MAX_int32 || !Grid->IsCellWalkable(Neighbor))
+			{
+				continue;
+			}
+			int32 MoveCost = Grid->GetMoveCost(AffectedCell, Neighbor, FOctileDistance::GetMoveCost(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]));
+			BestCost = FMath::Min(BestCost, Costs[Neighbor] + MoveCost);
+		}
+		if (BestCost != MAX_int32)
+		{
+			LowerCost(AffectedCell, BestCost);
+		}
+	}
+	// Spread the new costs, this also lowers unaffected cells that got a cheaper path through cells that became walkable or cheaper
+	SearchIntegration(ChangedMin, ChangedMax);
+	// Cells next to a cell whose cost changed can have a new best neighbor
+	UpdateDirections(ChangedMin - FIntPoint(1, 1), ChangedMax + FIntPoint(1, 1));
+}
+
+int32 FGridFlowField::GetGoalCell() const
+{
+	return GoalCell;
+}
+
+int32 FGridFlowField::GetCostToGoal(int32 CellIndex) const
+{
+	return Costs.IsValidIndex(CellIndex) ? Costs[CellIndex] : MAX_int32;
+}
+
+int32 FGridFlowField::GetNextCell(int32 CellIndex) const
+{
+	if (!Directions.IsValidIndex(CellIndex) || Directions[CellIndex] == NoDirection)
+	{
+		return INDEX_NONE;
+	}
+	return CellIndex + Grid->GetNeighborOffset(Directions[CellIndex]);
+}
+
+FVector2D FGridFlowField::GetDirection(int32 CellIndex) const
+{
+	if (!Directions.IsValidIndex(CellIndex) || Directions[CellIndex] == NoDirection)
+	{
+		return FVector2D::ZeroVector;
+	}
+	uint8 Direction = Directions[CellIndex];
+	return FVector2D(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]).GetSafeNormal();
+}
+
+int32 FGridFlowField::GetNumSearched() const
+{
+	return NumSearched;
+}
+
+void FGridFlowField::SearchIntegration(FIntPoint& ChangedMin, FIntPoint& ChangedMax)
+{
+	// Dijkstra search, the cell with the smallest cost is final when popped, moves cost the same in both directions so the search can run backwards from the goal
+	while (!OpenNodes.IsEmpty())
+	{
+		int32 CurrentCell = OpenNodes.Pop();
+		NumSearched++;
+		int32 CurrentX = Grid->GetCellX(CurrentCell);
+		int32 CurrentY = Grid->GetCellY(CurrentCell);
+		ChangedMin = FIntPoint(FMath::Min(ChangedMin.X, CurrentX), FMath::Min(ChangedMin.Y, CurrentY));
+		ChangedMax = FIntPoint(FMath::Max(ChangedMax.X, CurrentX), FMath::Max(ChangedMax.Y, CurrentY));
+		int32 CurrentCost = Costs[CurrentCell];
+		uint8 NeighborMask = Grid->GetNeighborMask(CurrentCell);
+		for (int32 Direction = 0; Direction < 8; Direction++)
+		{
+			int32 Neighbor = CurrentCell + Grid->GetNeighborOffset(Direction);
+			if (!(NeighborMask & (1 << Direction)) || !Grid->IsCellWalkable(Neighbor))
+			{
+				continue;
+			}
+			int32 Cost = CurrentCost + Grid->GetMoveCost(CurrentCell, Neighbor, FOctileDistance::GetMoveCost(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]));
+			if (Cost < Costs[Neighbor])
+			{
+				LowerCost(Neighbor, Cost);
+			}
+		}
+	}
+}
+
+void FGridFlowField::LowerCost(int32 CellIndex, int32 Cost)
+{
+	// The open set is ordered by cost only, h_cost is 0 for a Dijkstra search
+	Costs[CellIndex] = Cost;
+	if (OpenNodes.Contains(CellIndex))
+	{
+		OpenNodes.Update(CellIndex, Cost, 0);
+	}
+	else
+	{
+		OpenNodes.Add(CellIndex, Cost, 0);
+	}
+}
+
+void FGridFlowField::UpdateDirections(FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	MinIndex = FIntPoint(FMath::Max(MinIndex.X, 0), FMath::Max(MinIndex.Y, 0));
+	MaxIndex = FIntPoint(FMath::Min(MaxIndex.X, GridSizeX - 1), FMath::Min(MaxIndex.Y, GridSizeY - 1));
+	if (MinIndex.X > MaxIndex.X || MinIndex.Y > MaxIndex.Y)
+	{
+		return;
+	}
+	// Each tile only writes the directions of its own cells and reads the finished integration field, so tiles run in parallel
+	int32 NumTilesX = FMath::DivideAndRoundUp(MaxIndex.X - MinIndex.X + 1, DirectionTileSize);
+	int32 NumTilesY = FMath::DivideAndRoundUp(MaxIndex.Y - MinIndex.Y + 1, DirectionTileSize);
+	ParallelFor(NumTilesX * NumTilesY, [&](int32 TileIndex)
+	{
+		int32 TileMinX = MinIndex.X + (TileIndex % NumTilesX) * DirectionTileSize;
+		int32 TileMinY = MinIndex.Y + (TileIndex / NumTilesX) * DirectionTileSize;
+		for (int32 y = TileMinY; y <= FMath::Min(TileMinY + DirectionTileSize - 1, MaxIndex.Y); y++)
+		{
+			for (int32 x = TileMinX; x <= FMath::Min(TileMinX + DirectionTileSize - 1, MaxIndex.X); x++)
+			{
+				// Point each reachable cell to the neighbor with the smallest cost to the goal through it, the first one in neighbor order on ties
+				int32 CellIndex = Grid->GetCellIndex(x, y);
+				uint8 BestDirection = NoDirection;
+				if (CellIndex != GoalCell && Costs[CellIndex] != MAX_int32)
+				{
+					int32 BestCost = MAX_int32;
+					uint8 NeighborMask = Grid->GetNeighborMask(CellIndex);
+					for (int32 Direction = 0; Direction < 8; Direction++)
+					{
+						int32 Neighbor = CellIndex + Grid->GetNeighborOffset(Direction);
+						if (!(NeighborMask & (1 << Direction)) || Costs[Neighbor] == MAX_int32)
+						{
+							continue;
+						}
+						int32 Cost = Costs[Neighbor] + Grid->GetMoveCost(CellIndex, Neighbor, FOctileDistance::GetMoveCost(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]));
+						if (Cost < BestCost)
+						{
+							BestCost = Cost;
+							BestDirection = Direction;
+						}
+					}
+				}
+				Directions[CellIndex] = BestDirection;
+			}
+		}
+	});
+}
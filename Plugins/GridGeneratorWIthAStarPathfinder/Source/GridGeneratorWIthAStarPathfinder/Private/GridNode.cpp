@@ -27,8 +27,6 @@ AGridNode::AGridNode()
 	// Set the node initially to be invisible with no collision
 	NodeRepresentation->SetVisibility(false, false);
 	NodeRepresentation->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	// Initalize Parent Node to be nullptr
-	ParentNode = nullptr;
 }
 
 // Called when the game starts or when spawned
@@ -40,7 +38,7 @@ void AGridNode::BeginPlay()
 	NodeRepresentation->SetMaterial(0, DynamicMaterial);
 }
 
-void AGridNode::SetVariables(float in_radius, float in_height, bool in_bVisible, int gridX, int gridY)
+void AGridNode::SetVariables(float in_radius, float in_height, bool in_bVisible, int gridX, int gridY, bool in_bWalkable)
 {
 	// Set private variables from the input parameters
 	radius = in_radius;
@@ -49,8 +47,9 @@ void AGridNode::SetVariables(float in_radius, float in_height, bool in_bVisible,
 	GridIndexX = gridX;
 	GridIndexY = gridY;
 	NodeRepresentation->SetWorldScale3D(UKismetMathLibrary::Vector_One() * scalePercenatage);
-	// Change the color of the node based on whehter it's visible or not
+	// Change the color of the node based on whehter it's visible and walkable or not
 	bVisible = in_bVisible;
+	bWalkable = in_bWalkable;
 	SetColorOnWalkable();
 }
 
@@ -94,10 +93,20 @@ bool AGridNode::CheckWalkable()
 	return bWalkable;
 }
 
+bool AGridNode::IsWalkable() const
+{
+	return bWalkable;
+}
+
+void AGridNode::SetWalkable(bool in_bWalkable)
+{
+	bWalkable = in_bWalkable;
+}
+
 void AGridNode::SetColorOnWalkable()
 {
-	// Change the color and visibily of the node material based on CheckWalkable
-	if (CheckWalkable())
+	// Change the color and visibily of the node material based on the walkable state found by the last CheckWalkable
+	if (bWalkable)
 	{
 		ChangeColor(FColor::Blue, 0.5f);
 		NodeRepresentation->SetVisibility(bVisible, false);
@@ -116,12 +125,6 @@ void AGridNode::ChangeColor(FColor in_Color, float in_Opacity)
 	DynamicMaterial->SetScalarParameterValue(FName("Opacity"), in_Opacity);
 }
 
-int32 AGridNode::Getf_cost()
-{
-	// calculate the f_cost by adding g_cost and h_cost
-	return g_cost + h_cost;
-}
-
 void AGridNode::setNodeVisibility(bool in_bVisible)
 {
 	// Set the node visibility based on the input parameter
@@ -137,34 +140,4 @@ int32 AGridNode::GetGridIndexX() const
 int32 AGridNode::GetGridIndexY() const
 {
 	return GridIndexY;
-}
-
-void AGridNode::Setg_cost(int32 inValue)
-{
-	g_cost = inValue;
-}
-
-int32 AGridNode::Getg_cost() const
-{
-	return g_cost;
-}
-
-void AGridNode::Seth_cost(int32 inValue)
-{
-	h_cost = inValue;
-}
-
-int32 AGridNode::Geth_cost() const
-{
-	return h_cost;
-}
-
-void AGridNode::SetParentNode(AGridNode* inValue)
-{
-	ParentNode = inValue;
-}
-
-AGridNode* AGridNode::GetParentNode() const
-{
-	return ParentNode;
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 
 
 #include "MapGenerator.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Engine/StaticMeshActor.h"
 
 // Sets default values
@@ -39,6 +38,10 @@ void AMapGenerator::BeginPlay()
 	}
 	// Start by spawning the obstacles on the grid mesh
 	SpawnObstacles();
+	// Get notified when the grid finished baking on the worker threads
+	Grid->OnGridCreated.AddUObject(this, &AMapGenerator::OnGridCreated);
+	// Search the shown path again when an obstacle moves onto it
+	PathfinderComponent->OnCurrentPathInvalidated.AddUObject(this, &AMapGenerator::RequestPath);
 	// Create TimerHandle variable to start the CreateGrid method from Grid class after a delay
 	FTimerHandle TH_Delay;
 	GetWorld()->GetTimerManager().SetTimer(TH_Delay, this, &AMapGenerator::CreateGridAfterDelay, 0.2f, false, 0.2f);
@@ -46,8 +49,12 @@ void AMapGenerator::BeginPlay()
 
 void AMapGenerator::CreateGridAfterDelay()
 {
-	// Spawn the GridNodes on the Grid Mesh after a delay
+	// Start baking the grid after a delay, the cells are traced on worker threads and OnGridCreated is called when they are published
 	Grid->CreateGrid();
+}
+
+void AMapGenerator::OnGridCreated()
+{
 	UE_LOG(LogTemp, Warning, TEXT("Grid Created"));
 }
 
@@ -59,6 +66,12 @@ void AMapGenerator::PathBetween2RandomPoints()
 		UE_LOG(LogTemp, Error, TEXT("Need to set the Grid variable in editor"));
 		return;
 	}
+	// Ensure the grid finished baking its cells, no cell is walkable before that
+	if (Grid->IsCreatingGrid() || Grid->GetNumCells() == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Grid is still being created"));
+		return;
+	}
 	// Get the bottom left corner and top right corner locations using GridWorldSize, and create variable for min and max allowable values for random x and y postions
 	FVector2D GridWorldSize = Grid->GetGridWorldSize();
 	FVector BottomLeftLocation = Grid->GetActorLocation() + FVector(-1.f * GridWorldSize.X / 2.0f, -1.f * GridWorldSize.Y / 2.0f, Grid->GetActorLocation().Z);
@@ -68,21 +81,21 @@ void AMapGenerator::PathBetween2RandomPoints()
 	float minY = BottomLeftLocation.Y;
 	float maxY = TopRightLocation.Y;
 	float locZ = Grid->GetActorLocation().Z;
-	// Initialize walkable with false, create pointer for startNode and TargetNode
+	// Initialize walkable with false, create indices for StartCell and TargetCell
 	bool bWalkable = false;
-	AGridNode* StartNode = nullptr;
-	AGridNode* TargetNode = nullptr;
+	int32 StartCell = INDEX_NONE;
+	int32 TargetCell = INDEX_NONE;
 	// Get random start location and target location in the bounds of bottom left corner and top right corner
-	// Use Start and Target Locations to get Start and End Nodes
-	// Check if both Start and Target Node are walkable, use the output to set the bWalkable variable
-	// if bWalkable is false, repeat the whole process till we get valid start and target nodes
+	// Use Start and Target Locations to get Start and Target cells
+	// Check if both Start and Target cells are walkable, use the output to set the bWalkable variable
+	// if bWalkable is false, repeat the whole process till we get valid start and target cells
 	while (!bWalkable)
 	{
-		FVector StartLocation = FVector(UKismetMathLibrary::RandomFloatInRange(minX, maxX), UKismetMathLibrary::RandomFloatInRange(minY, maxY), locZ);
-		FVector TargetLocation = FVector(UKismetMathLibrary::RandomFloatInRange(minX, maxX), UKismetMathLibrary::RandomFloatInRange(minY, maxY), locZ);
-		StartNode = Grid->NodeFromLocation(StartLocation);
-		TargetNode = Grid->NodeFromLocation(TargetLocation);
-		bWalkable = StartNode->CheckWalkable() && TargetNode->CheckWalkable();
+		FVector StartLocation = FVector(RandomStream.FRandRange(minX, maxX), RandomStream.FRandRange(minY, maxY), locZ);
+		FVector TargetLocation = FVector(RandomStream.FRandRange(minX, maxX), RandomStream.FRandRange(minY, maxY), locZ);
+		StartCell = Grid->CellFromLocation(StartLocation);
+		TargetCell = Grid->CellFromLocation(TargetLocation);
+		bWalkable = Grid->IsCellWalkable(StartCell) && Grid->IsCellWalkable(TargetCell);
 	}
 	// Ensure grid in the pathfinder actor component
 	if (!PathfinderComponent->Grid)
@@ -90,8 +103,33 @@ void AMapGenerator::PathBetween2RandomPoints()
 		UE_LOG(LogTemp, Error, TEXT("Grid variable not set in the pathfinder component"));
 		return;
 	}
-	// Call the method on Pathfinder to get the shortest path between Start and Target Node
-	PathfinderComponent->FindPathNode(StartNode, TargetNode);
+	// Remember the cells, so the path can be searched again when obstacles move
+	PathStartCell = StartCell;
+	PathTargetCell = TargetCell;
+	RequestPath();
+}
+
+void AMapGenerator::RequestPath()
+{
+	// Cancel the last path query if it's still running, then find the shortest path between Start and Target cells on a worker thread so the game thread isn't stalled by the search
+	PathfinderComponent->CancelPathQuery(PathQueryHandle);
+	PathQueryHandle = PathfinderComponent->FindPathCellAsync(PathStartCell, PathTargetCell, FOnPathQueryComplete::CreateUObject(this, &AMapGenerator::OnPathFound));
+}
+
+void AMapGenerator::OnPathFound(const FPathQueryResult& Result)
+{
+	// If an obstacle moved onto the path while it was searched, search it again instead of showing it
+	if (Result.bNeedsRepath)
+	{
+		RequestPath();
+		return;
+	}
+	// Show the found path on the grid, and print to log the time the search took on the worker thread
+	if (Result.bPathFound)
+	{
+		PathfinderComponent->ShowPath(Result.Path);
+		UE_LOG(LogTemp, Warning, TEXT("Total Time taken by Algorithm in milliseconds: %f"), Result.SearchTimeMs);
+	}
 }
 
 void AMapGenerator::SpawnObstacles()
@@ -105,17 +143,19 @@ void AMapGenerator::SpawnObstacles()
 	float minY = BottomLeftLocation.Y;
 	float maxY = TopRightLocation.Y;
 	float locZ = Grid->GetActorLocation().Z;
+	// Restart the random stream, so the obstacles and the random points after them only depend on the seed
+	RandomStream.Initialize(RandomSeed != 0 ? RandomSeed : FMath::Rand());
 	// Spawn number of static mesh actors to be used as obstacles equal to nBlockingObstacles
 	for (int32 i = 0; i < nBlockingObstacles; i++)
 	{
 		// Get random spawn location in the bounds of bottom left and top right locations
-		FVector SpawnLocation = FVector(UKismetMathLibrary::RandomFloatInRange(minX, maxX), UKismetMathLibrary::RandomFloatInRange(minY, maxY), locZ);
+		FVector SpawnLocation = FVector(RandomStream.FRandRange(minX, maxX), RandomStream.FRandRange(minY, maxY), locZ);
 		// Spawn static mesh actor in the random spawn location
 		AStaticMeshActor* SpawnedMesh = GetWorld()->SpawnActor<AStaticMeshActor>(SpawnLocation, FRotator(0.0f, 0.0f, 0.0f));
 		// If Static Mesh actor successully spawned randomize it's scale in the x and y directions
 		if (SpawnedMesh)
 		{
-			FVector MeshScale = FVector(UKismetMathLibrary::RandomFloatInRange(1, 5), UKismetMathLibrary::RandomFloatInRange(1, 5), 3.0f);
+			FVector MeshScale = FVector(RandomStream.FRandRange(1, 5), RandomStream.FRandRange(1, 5), 3.0f);
 			// Set static mesh to be BlockingObstacleMesh
 			SpawnedMesh->GetStaticMeshComponent()->SetStaticMesh(BlockingObstacleShape);
 			SpawnedMesh->GetStaticMeshComponent()->SetWorldScale3D(MeshScale);
@@ -131,19 +171,21 @@ void AMapGenerator::SpawnObstacles()
 	for (int32 i = 0; i < nNonblockingObstacles; i++)
 	{
 		// Get random spawn location in the bounds of bottom left and top right locations
-		FVector SpawnLocation = FVector(UKismetMathLibrary::RandomFloatInRange(minX, maxX), UKismetMathLibrary::RandomFloatInRange(minY, maxY), locZ);
+		FVector SpawnLocation = FVector(RandomStream.FRandRange(minX, maxX), RandomStream.FRandRange(minY, maxY), locZ);
 		// Spawn static mesh actor in the random spawn location
 		AStaticMeshActor* SpawnedMesh = GetWorld()->SpawnActor<AStaticMeshActor>(SpawnLocation, FRotator(0.0f, 0.0f, 0.0f));
 		// If Static Mesh actor successully spawned randomize it's scale in the x and y directions
 		if (SpawnedMesh)
 		{
 			// Get Random rotator for the spawned mesh
-			FRotator MeshRotator = FRotator(0.0f, UKismetMathLibrary::RandomBool() * 90.0f, 0.0f);
+			FRotator MeshRotator = FRotator(0.0f, RandomStream.RandRange(0, 1) * 90.0f, 0.0f);
 			// Set static mesh to be NonBlockingObstacleMesh
 			SpawnedMesh->GetStaticMeshComponent()->SetStaticMesh(NonBlockingObstacleShape);
 			SpawnedMesh->GetStaticMeshComponent()->Mobility = EComponentMobility::Movable;
 			SpawnedMesh->SetActorScale3D(FVector(1.5f, 5.0f, 1.0f));
 			SpawnedMesh->SetActorRotation(MeshRotator);
+			// Movable meshes can change the walkable cells under them at any time, so the grid rebakes them when they move
+			Grid->RegisterDynamicObstacle(SpawnedMesh);
 			// Add the spawed static mesh actor to the SpawnedMeshes array
 			SpawnedMeshes.Add(SpawnedMesh);
 		}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NodeHeap.h"
+
+void FNodeHeap::Initialize(int32 NumCells)
+{
+	// Remove the cells left from the last search, then grow the heap positions array if the grid got bigger
+	Reset();
+	if (HeapIndices.Num() != NumCells)
+	{
+		HeapIndices.Init(INDEX_NONE, NumCells);
+	}
+}
+
+void FNodeHeap::Add(int32 CellIndex, int32 f_cost, int32 h_cost)
+{
+	// Add the cell at the end of the heap array with the next sequence number, so cells with equal costs are popped in the order they were added
+	int32 Index = HeapEntries.Add({ f_cost, h_cost, NextSequence++, CellIndex });
+	HeapIndices[CellIndex] = Index;
+	// Move the cell up to its correct position
+	SiftUp(Index);
+}
+
+int32 FNodeHeap::Pop()
+{
+	if (HeapEntries.IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+	// Take the cell at the top of the heap, and move the last entry in its place
+	int32 TopCell = HeapEntries[0].CellIndex;
+	SwapEntries(0, HeapEntries.Num() - 1);
+	HeapEntries.Pop(false);
+	HeapIndices[TopCell] = INDEX_NONE;
+	// Move the entry placed at the top down to its correct position
+	if (!HeapEntries.IsEmpty())
+	{
+		SiftDown(0);
+	}
+	return TopCell;
+}
+
+void FNodeHeap::Update(int32 CellIndex, int32 f_cost, int32 h_cost)
+{
+	// Costs of cells in the open set only decrease, so the cell can only move up in the heap
+	int32 Index = HeapIndices[CellIndex];
+	HeapEntries[Index].f_cost = f_cost;
+	HeapEntries[Index].h_cost = h_cost;
+	SiftUp(Index);
+}
+
+void FNodeHeap::Reprioritize(int32 CellIndex, int32 f_cost, int32 h_cost)
+{
+	// The entry can move either way, only one of the sifts moves it
+	int32 Index = HeapIndices[CellIndex];
+	HeapEntries[Index].f_cost = f_cost;
+	HeapEntries[Index].h_cost = h_cost;
+	SiftUp(Index);
+	SiftDown(HeapIndices[CellIndex]);
+}
+
+void FNodeHeap::Remove(int32 CellIndex)
+{
+	int32 Index = HeapIndices[CellIndex];
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+	// Move the last entry in place of the removed one, then move it up or down to its correct position
+	int32 LastIndex = HeapEntries.Num() - 1;
+	SwapEntries(Index, LastIndex);
+	HeapEntries.Pop(false);
+	HeapIndices[CellIndex] = INDEX_NONE;
+	if (Index < HeapEntries.Num())
+	{
+		int32 MovedCell = HeapEntries[Index].CellIndex;
+		SiftUp(Index);
+		SiftDown(HeapIndices[MovedCell]);
+	}
+}
+
+int32 FNodeHeap::Top() const
+{
+	return HeapEntries.IsEmpty() ? INDEX_NONE : HeapEntries[0].CellIndex;
+}
+
+void FNodeHeap::GetTopCosts(int32& Outf_cost, int32& Outh_cost) const
+{
+	Outf_cost = HeapEntries[0].f_cost;
+	Outh_cost = HeapEntries[0].h_cost;
+}
+
+bool FNodeHeap::Contains(int32 CellIndex) const
+{
+	return HeapIndices[CellIndex] != INDEX_NONE;
+}
+
+bool FNodeHeap::IsEmpty() const
+{
+	return HeapEntries.IsEmpty();
+}
+
+int32 FNodeHeap::Num() const
+{
+	return HeapEntries.Num();
+}
+
+void FNodeHeap::Reset()
+{
+	// Clear the heap position of the cells still in the heap, and empty the array without freeing its memory
+	for (const FHeapEntry& Entry : HeapEntries)
+	{
+		HeapIndices[Entry.CellIndex] = INDEX_NONE;
+	}
+	HeapEntries.Reset();
+	NextSequence = 0;
+}
+
+bool FNodeHeap::IsHigherPriority(const FHeapEntry& A, const FHeapEntry& B) const
+{
+	// Cell with smaller f_cost first, if f_cost is equal the one with the smaller h_cost, if both are equal the one that was added first
+	if (A.f_cost != B.f_cost)
+	{
+		return A.f_cost < B.f_cost;
+	}
+	if (A.h_cost != B.h_cost)
+	{
+		return A.h_cost < B.h_cost;
+	}
+	return A.Sequence < B.Sequence;
+}
+
+void FNodeHeap::SiftUp(int32 Index)
+{
+	// Swap the entry with its parent as long as it has a higher priority than the parent
+	while (Index > 0)
+	{
+		int32 ParentIndex = (Index - 1) / 2;
+		if (!IsHigherPriority(HeapEntries[Index], HeapEntries[ParentIndex]))
+		{
+			break;
+		}
+		SwapEntries(Index, ParentIndex);
+		Index = ParentIndex;
+	}
+}
+
+void FNodeHeap::SiftDown(int32 Index)
+{
+	// Swap the entry with its child of highest priority as long as that child has a higher priority than the entry
+	int32 NumEntries = HeapEntries.Num();
+	while (true)
+	{
+		int32 LeftIndex = Index * 2 + 1;
+		int32 RightIndex = LeftIndex + 1;
+		int32 BestIndex = Index;
+		if (LeftIndex < NumEntries && IsHigherPriority(HeapEntries[LeftIndex], HeapEntries[BestIndex]))
+		{
+			BestIndex = LeftIndex;
+		}
+		if (RightIndex < NumEntries && IsHigherPriority(HeapEntries[RightIndex], HeapEntries[BestIndex]))
+		{
+			BestIndex = RightIndex;
+		}
+		if (BestIndex == Index)
+		{
+			break;
+		}
+		SwapEntries(Index, BestIndex);
+		Index = BestIndex;
+	}
+}
+
+void FNodeHeap::SwapEntries(int32 IndexA, int32 IndexB)
+{
+	HeapEntries.Swap(IndexA, IndexB);
+	HeapIndices[HeapEntries[IndexA].CellIndex] = IndexA;
+	HeapIndices[HeapEntries[IndexB].CellIndex] = IndexB;
+}
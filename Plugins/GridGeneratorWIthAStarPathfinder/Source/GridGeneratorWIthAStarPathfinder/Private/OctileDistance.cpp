@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OctileDistance.h"
+#include "Math/VectorRegister.h"
+
+void FOctileDistance::GetBatch(const int32* IndicesX, const int32* IndicesY, int32 Num, int32 TargetX, int32 TargetY, int32* OutDistances)
+{
+	int32 Index = 0;
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	// Evaluate 4 cells per iteration from the packed X and Y indices, same integer math as Get so the results are bit exact
+	const VectorRegister4Int TargetXs = VectorIntSet1(TargetX);
+	const VectorRegister4Int TargetYs = VectorIntSet1(TargetY);
+	const VectorRegister4Int StraightCosts = VectorIntSet1(StraightCost);
+	const VectorRegister4Int DiagonalExtraCosts = VectorIntSet1(DiagonalCost - StraightCost);
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		VectorRegister4Int DistanceX = VectorIntAbs(VectorIntSubtract(VectorIntLoad(IndicesX + Index), TargetXs));
+		VectorRegister4Int DistanceY = VectorIntAbs(VectorIntSubtract(VectorIntLoad(IndicesY + Index), TargetYs));
+		VectorRegister4Int StraightPart = VectorIntMultiply(VectorIntMax(DistanceX, DistanceY), StraightCosts);
+		VectorRegister4Int DiagonalPart = VectorIntMultiply(VectorIntMin(DistanceX, DistanceY), DiagonalExtraCosts);
+		VectorIntStore(VectorIntAdd(StraightPart, DiagonalPart), OutDistances + Index);
+	}
+#endif
+	// Scalar fallback for the remaining cells, or all cells on platforms without vector intrinsics
+	for (; Index < Num; Index++)
+	{
+		OutDistances[Index] = Get(IndicesX[Index] - TargetX, IndicesY[Index] - TargetY);
+	}
+#if DO_GUARD_SLOW
+	// Verify the vector results against the scalar function in debug builds
+	for (int32 CheckIndex = 0; CheckIndex < Num; CheckIndex++)
+	{
+		checkSlow(OutDistances[CheckIndex] == Get(IndicesX[CheckIndex] - TargetX, IndicesY[CheckIndex] - TargetY));
+	}
+#endif
+}
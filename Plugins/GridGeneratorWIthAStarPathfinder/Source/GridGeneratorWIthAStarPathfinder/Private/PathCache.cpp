@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathCache.h"
+
+FPathCache::FPathCache()
+	// The cache holds no results until SetMaxMemory raises the memory cap, the entry count of the LRU cache is derived from it
+	: Entries(MaxNumEntries)
+{
+}
+
+bool FPathCache::Find(const FPathCacheKey& Key, TArray<int32>& OutPath)
+{
+	FScopeLock Lock(&CacheLock);
+	// Results of other Grid versions are never returned, a newer version empties the cache
+	const TArray<int32>* CachedPath = UpdateVersion(Key.GridVersion) ? Entries.FindAndTouch(Key) : nullptr;
+	if (CachedPath == nullptr)
+	{
+		Stats.NumMisses++;
+		return false;
+	}
+	Stats.NumHits++;
+	OutPath = *CachedPath;
+	return true;
+}
+
+void FPathCache::Add(const FPathCacheKey& Key, const TArray<int32>& Path)
+{
+	FScopeLock Lock(&CacheLock);
+	int64 EntryMemory = GetEntryMemory(Path);
+	// Skip results found on an older Grid version, and results that can't fit in the cache
+	if (!UpdateVersion(Key.GridVersion) || EntryMemory > MaxMemoryBytes)
+	{
+		return;
+	}
+	// Replace the result already cached for the key
+	if (const TArray<int32>* CachedPath = Entries.FindAndTouch(Key))
+	{
+		Stats.MemoryBytes -= GetEntryMemory(*CachedPath);
+		Entries.Remove(Key);
+	}
+	// Remove the least recently used results until the new result fits
+	while (Entries.Num() > 0 && Stats.MemoryBytes + EntryMemory > MaxMemoryBytes)
+	{
+		Stats.MemoryBytes -= GetEntryMemory(Entries.RemoveLeastRecent());
+		Stats.NumEvictions++;
+	}
+	Entries.Add(Key, Path);
+	Stats.MemoryBytes += EntryMemory;
+	Stats.NumEntries = Entries.Num();
+}
+
+void FPathCache::SetMaxMemory(int64 InMaxMemoryBytes)
+{
+	FScopeLock Lock(&CacheLock);
+	MaxMemoryBytes = FMath::Max<int64>(InMaxMemoryBytes, 0);
+	// The LRU cache presizes its lookup set to its entry count, so the count is the most results of the smallest size that fit in the memory cap
+	// The count can only be changed by emptying the cache, the cap is set when the Grid is published so there are no results to lose then
+	int32 NewMaxNumEntries = (int32)FMath::Clamp<int64>(MaxMemoryBytes / GetEntryMemory(TArray<int32>()), 1, MAX_int32);
+	if (NewMaxNumEntries != MaxNumEntries)
+	{
+		MaxNumEntries = NewMaxNumEntries;
+		EmptyEntries();
+		return;
+	}
+	// Remove the least recently used results above the new cap
+	while (Entries.Num() > 0 && Stats.MemoryBytes > MaxMemoryBytes)
+	{
+		Stats.MemoryBytes -= GetEntryMemory(Entries.RemoveLeastRecent());
+		Stats.NumEvictions++;
+	}
+	Stats.NumEntries = Entries.Num();
+}
+
+void FPathCache::Empty()
+{
+	FScopeLock Lock(&CacheLock);
+	EmptyEntries();
+}
+
+FPathCacheStats FPathCache::GetStats() const
+{
+	FScopeLock Lock(&CacheLock);
+	return Stats;
+}
+
+bool FPathCache::UpdateVersion(uint32 GridVersion)
+{
+	// Versions only increase, so results of a newer version make all cached results stale
+	if (GridVersion > CachedVersion)
+	{
+		EmptyEntries();
+		CachedVersion = GridVersion;
+	}
+	return GridVersion == CachedVersion;
+}
+
+void FPathCache::EmptyEntries()
+{
+	// Keep the entry count derived from the memory cap, the memory cap stays the limit of the cache
+	Entries.Empty(MaxNumEntries);
+	Stats.NumEntries = 0;
+	Stats.MemoryBytes = 0;
+}
+
+int64 FPathCache::GetEntryMemory(const TArray<int32>& Path)
+{
+	// Key, path array and its cells, the lookup overhead of the LRU cache is small compared to the cells of a path
+	return sizeof(FPathCacheKey) + sizeof(TArray<int32>) + Path.Num() * sizeof(int32);
+}
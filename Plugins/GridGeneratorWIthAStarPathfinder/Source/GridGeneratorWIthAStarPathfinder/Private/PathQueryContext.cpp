@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathQueryContext.h"
+
+void FPathQueryContext::BeginQuery(int32 NumCells, int32 InStartCell, int32 InTargetCell)
+{
+	StartCell = InStartCell;
+	TargetCell = InTargetCell;
+	NumAnalyzed = 0;
+	NumAnalyzedBackward = 0;
+	NumWalkabilityLookups = 0;
+	PeakOpenNodes = 0;
+	QueryStartAllocations = GetNumAllocations();
+	NumBackwardAllocations = 0;
+	// Allocate zeroed records the first time the context is used on a grid of this size, zero is never a valid generation
+	if (Records.Num() != NumCells)
+	{
+		Records.SetNumZeroed(NumCells);
+		Generation = 0;
+		NumRecordAllocations++;
+	}
+	// Move to the next generation so all records written by the last query become invalid
+	Generation++;
+	// If the generation wrapped around, records could match it again, so clear them once and restart from 1
+	if (Generation == 0)
+	{
+		FMemory::Memzero(Records.GetData(), Records.Num() * sizeof(FCellRecord));
+		Generation = 1;
+	}
+	// Remove the cells left in the open set by the last query
+	OpenNodes.Initialize(NumCells);
+}
+
+int32 FPathQueryContext::GetStartCell() const
+{
+	return StartCell;
+}
+
+int32 FPathQueryContext::GetTargetCell() const
+{
+	return TargetCell;
+}
+
+int32 FPathQueryContext::GetNumCells() const
+{
+	return Records.Num();
+}
+
+int32 FPathQueryContext::GetNumAnalyzed() const
+{
+	return NumAnalyzed;
+}
+
+int32 FPathQueryContext::GetNumAnalyzedBackward() const
+{
+	return NumAnalyzedBackward;
+}
+
+void FPathQueryContext::AddBackwardQuery(const FPathQueryContext& Backward)
+{
+	NumAnalyzed += Backward.GetNumAnalyzed();
+	NumAnalyzedBackward += Backward.GetNumAnalyzed();
+	NumWalkabilityLookups += Backward.GetNumWalkabilityLookups();
+	PeakOpenNodes += Backward.GetPeakOpenNodes();
+	NumBackwardAllocations += Backward.GetNumQueryAllocations();
+}
+
+int32 FPathQueryContext::GetNumWalkabilityLookups() const
+{
+	return NumWalkabilityLookups;
+}
+
+void FPathQueryContext::AddWalkabilityLookups(int32 Num)
+{
+	NumWalkabilityLookups += Num;
+}
+
+int32 FPathQueryContext::GetPeakOpenNodes() const
+{
+	return PeakOpenNodes;
+}
+
+void FPathQueryContext::UpdatePeakOpenNodes(int32 NumOpenNodes)
+{
+	PeakOpenNodes = FMath::Max(PeakOpenNodes, NumOpenNodes);
+}
+
+int32 FPathQueryContext::GetNumQueryAllocations() const
+{
+	return GetNumAllocations() - QueryStartAllocations + NumBackwardAllocations;
+}
+
+bool FPathQueryContext::IsVisited(int32 CellIndex) const
+{
+	return Records[CellIndex].VisitedGeneration == Generation;
+}
+
+bool FPathQueryContext::IsAnalyzed(int32 CellIndex) const
+{
+	return Records[CellIndex].AnalyzedGeneration == Generation;
+}
+
+void FPathQueryContext::SetAnalyzed(int32 CellIndex)
+{
+	Records[CellIndex].AnalyzedGeneration = Generation;
+	NumAnalyzed++;
+}
+
+void FPathQueryContext::Visit(int32 CellIndex, int32 g_cost, int32 h_cost, int32 ParentCell)
+{
+	FCellRecord& Record = Records[CellIndex];
+	Record.g_cost = g_cost;
+	Record.h_cost = h_cost;
+	Record.ParentCell = ParentCell;
+	Record.VisitedGeneration = Generation;
+}
+
+int32 FPathQueryContext::Getg_cost(int32 CellIndex) const
+{
+	return Records[CellIndex].g_cost;
+}
+
+int32 FPathQueryContext::Geth_cost(int32 CellIndex) const
+{
+	return Records[CellIndex].h_cost;
+}
+
+int32 FPathQueryContext::Getf_cost(int32 CellIndex) const
+{
+	// calculate the f_cost by adding g_cost and h_cost
+	return Records[CellIndex].g_cost + Records[CellIndex].h_cost;
+}
+
+int32 FPathQueryContext::GetParentCell(int32 CellIndex) const
+{
+	return Records[CellIndex].ParentCell;
+}
+
+FNodeHeap& FPathQueryContext::GetOpenNodes()
+{
+	return OpenNodes;
+}
+
+FPathQueryArena& FPathQueryContext::GetArena()
+{
+	return Arena;
+}
+
+int32 FPathQueryContext::GetNumAllocations() const
+{
+	return NumRecordAllocations + Arena.GetNumAllocations();
+}
+
+TArray<int32>& FPathQueryArena::AllocateArray()
+{
+	// Create a new array only if all arrays are taken by the current query
+	if (NumUsedArrays == Arrays.Num())
+	{
+		Arrays.Add(MakeUnique<TArray<int32>>());
+		ArrayCapacities.Add(0);
+		NumAllocations++;
+	}
+	TArray<int32>& Array = *Arrays[NumUsedArrays];
+	ArrayCapacities[NumUsedArrays] = Array.Max();
+	NumUsedArrays++;
+	Array.Reset();
+	return Array;
+}
+
+FNodeHeap& FPathQueryArena::AllocateHeap()
+{
+	// Create a new heap only if all heaps are taken by the current query, the user initializes it to its number of cells
+	if (NumUsedHeaps == Heaps.Num())
+	{
+		Heaps.Add(MakeUnique<FNodeHeap>());
+		NumAllocations++;
+	}
+	FNodeHeap& Heap = *Heaps[NumUsedHeaps++];
+	Heap.Reset();
+	return Heap;
+}
+
+void FPathQueryArena::Reset()
+{
+	// Count the arrays that had to grow while they were taken, then make all arrays and heaps free again
+	for (int32 ArrayIndex = 0; ArrayIndex < NumUsedArrays; ArrayIndex++)
+	{
+		if (Arrays[ArrayIndex]->Max() > ArrayCapacities[ArrayIndex])
+		{
+			NumAllocations++;
+		}
+	}
+	NumUsedArrays = 0;
+	NumUsedHeaps = 0;
+}
+
+int32 FPathQueryArena::GetNumAllocations() const
+{
+	return NumAllocations;
+}
+
+TUniquePtr<FPathQueryContext> FPathQueryContextPool::Acquire()
+{
+	// Reuse the last released context if there is one, it keeps its records allocated
+	{
+		FScopeLock Lock(&PoolLock);
+		if (!FreeContexts.IsEmpty())
+		{
+			return FreeContexts.Pop(false);
+		}
+	}
+	return MakeUnique<FPathQueryContext>();
+}
+
+void FPathQueryContextPool::Release(TUniquePtr<FPathQueryContext> Context)
+{
+	FScopeLock Lock(&PoolLock);
+	FreeContexts.Add(MoveTemp(Context));
+}
+
+void FPathQueryContextPool::Empty()
+{
+	FScopeLock Lock(&PoolLock);
+	FreeContexts.Empty();
+}
+
+FScopedPathQueryContext::FScopedPathQueryContext(FPathQueryContextPool& InPool)
+	: Pool(InPool)
+	, Context(InPool.Acquire())
+{
+}
+
+FScopedPathQueryContext::~FScopedPathQueryContext()
+{
+	Pool.Release(MoveTemp(Context));
+}
+
+FPathQueryContext& FScopedPathQueryContext::Get() const
+{
+	return *Context;
+}
@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathRequestScheduler.h"
+#include "PathfindingStats.h"
+
+// Sets default values for this component's properties
+UPathRequestScheduler::UPathRequestScheduler()
+{
+	// Tick every frame to run the queued searches
+	PrimaryComponentTick.bCanEverTick = true;
+	// Initialize Pathfinder to be null pointer until it's found in BeginPlay
+	Pathfinder = nullptr;
+}
+
+void UPathRequestScheduler::BeginPlay()
+{
+	Super::BeginPlay();
+	// Find the Pathfinder component on the owner, it's used to run the searches on its Grid
+	Pathfinder = GetOwner()->FindComponentByClass<UPathfinder>();
+	if (!Pathfinder)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Path request scheduler needs a Pathfinder component on the same actor"));
+	}
+}
+
+void UPathRequestScheduler::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Drop all queued searches, returning the contexts of started ones to the Grid pool
+	for (auto& Search : Searches)
+	{
+		if (Search->Context && Pathfinder && Pathfinder->Grid)
+		{
+			Pathfinder->Grid->GetQueryContextPool().Release(MoveTemp(Search->Context));
+		}
+	}
+	Searches.Empty();
+	SearchesByCells.Empty();
+	SearchesByQueryId.Empty();
+	Super::EndPlay(EndPlayReason);
+}
+
+void UPathRequestScheduler::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	// Ensure the pathfinder and its Grid are set before running any search
+	if (!Pathfinder || !Pathfinder->Grid || Searches.IsEmpty())
+	{
+		Stats.LastFrameTimeUs = 0.0;
+		return;
+	}
+	double StartTime = FPlatformTime::Seconds();
+	double EndTime = StartTime + FrameBudgetMicroseconds / 1000000.0;
+	// Order the searches by priority, searches with the same priority in the order they were queued, so started searches keep their place
+	Searches.StableSort([](const TUniquePtr<FScheduledPathSearch>& A, const TUniquePtr<FScheduledPathSearch>& B)
+	{
+		if (A->Priority != B->Priority)
+		{
+			return A->Priority > B->Priority;
+		}
+		return A->EnqueueTime < B->EnqueueTime;
+	});
+	// Advance the searches in order until the budget is spent, a search not finished when the budget runs out keeps its context and continues next frame
+	int32 SearchIndex = 0;
+	double CurrentTime = StartTime;
+	while (SearchIndex < Searches.Num() && CurrentTime < EndTime)
+	{
+		FScheduledPathSearch& Search = *Searches[SearchIndex];
+		TArray<int32> Path;
+		EPathSearchStatus Status = EPathSearchStatus::InProgress;
+		// The first time the search is advanced, deliver the cached result if the pathfinder uses the path cache and the same search ran on the current Grid version
+		// Else take a context from the Grid pool and start the search
+		if (!Search.Context)
+		{
+			Search.GridVersion = Pathfinder->Grid->GetGridVersion();
+			if (Pathfinder->bUsePathCache && Pathfinder->Grid->GetPathCache().Find(Pathfinder->GetPathCacheKey(Search.StartCell, Search.TargetCell, Search.GridVersion, false), Path))
+			{
+				Status = Path.IsEmpty() ? EPathSearchStatus::NoPath : EPathSearchStatus::PathFound;
+			}
+			else
+			{
+				Search.Context = Pathfinder->Grid->GetQueryContextPool().Acquire();
+				Pathfinder->BeginSearch(*Search.Context, Search.StartCell, Search.TargetCell);
+			}
+		}
+		if (Search.Context)
+		{
+			Status = Pathfinder->StepSearch(*Search.Context, IterationsPerStep, Path);
+		}
+		double StepEndTime = FPlatformTime::Seconds();
+		Search.SearchTimeMs += (StepEndTime - CurrentTime) * 1000.0;
+		CurrentTime = StepEndTime;
+		// Remove finished searches from the queue before delivering them, since requester delegates can queue or cancel other requests
+		// Unfinished searches are advanced again while the budget allows
+		if (Status != EPathSearchStatus::InProgress)
+		{
+			TUniquePtr<FScheduledPathSearch> FinishedSearch = MoveTemp(Searches[SearchIndex]);
+			Searches.RemoveAt(SearchIndex);
+			CompleteSearch(*FinishedSearch, Status, MoveTemp(Path));
+		}
+	}
+	Stats.LastFrameTimeUs = (CurrentTime - StartTime) * 1000000.0;
+}
+
+FPathQueryHandle UPathRequestScheduler::RequestPath(FVector StartPos, FVector TargetPos, int32 Priority, FOnPathQueryComplete OnComplete)
+{
+	// Ensure the pathfinder and its Grid are set before operation
+	if (!Pathfinder || !Pathfinder->Grid)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return FPathQueryHandle();
+	}
+	// Calculate Start and target cells from start and target positions, and queue the request if both are valid
+	int32 StartCell = Pathfinder->Grid->CellFromLocation(StartPos);
+	int32 TargetCell = Pathfinder->Grid->CellFromLocation(TargetPos);
+	if (StartCell == INDEX_NONE || TargetCell == INDEX_NONE)
+	{
+		return FPathQueryHandle();
+	}
+	return RequestPathCell(StartCell, TargetCell, Priority, MoveTemp(OnComplete));
+}
+
+FPathQueryHandle UPathRequestScheduler::RequestPathCell(int32 StartCell, int32 TargetCell, int32 Priority, FOnPathQueryComplete OnComplete)
+{
+	uint32 QueryId = NextQueryId++;
+	if (NextQueryId == 0)
+	{
+		NextQueryId = 1;
+	}
+	double RequestTime = FPlatformTime::Seconds();
+	Stats.NumRequested++;
+	// If a search between the same cells is already queued, add this request to its requesters and raise its priority if needed
+	uint64 CellsKey = GetCellsKey(StartCell, TargetCell);
+	FScheduledPathSearch* Search = SearchesByCells.FindRef(CellsKey);
+	if (Search)
+	{
+		Stats.NumDeduplicated++;
+		Search->Priority = FMath::Max(Search->Priority, Priority);
+	}
+	// Else queue a new search for this request
+	else
+	{
+		TUniquePtr<FScheduledPathSearch> NewSearch = MakeUnique<FScheduledPathSearch>();
+		NewSearch->StartCell = StartCell;
+		NewSearch->TargetCell = TargetCell;
+		NewSearch->Priority = Priority;
+		NewSearch->EnqueueTime = RequestTime;
+		Search = NewSearch.Get();
+		Searches.Add(MoveTemp(NewSearch));
+		SearchesByCells.Add(CellsKey, Search);
+	}
+	Search->Requesters.Add(FPathRequester{ QueryId, MoveTemp(OnComplete), RequestTime });
+	SearchesByQueryId.Add(QueryId, Search);
+	return FPathQueryHandle{ QueryId };
+}
+
+void UPathRequestScheduler::CancelRequest(FPathQueryHandle Handle)
+{
+	// Find the search the request is waiting for, and remove the request from its requesters
+	FScheduledPathSearch* Search = nullptr;
+	if (!SearchesByQueryId.RemoveAndCopyValue(Handle.QueryId, Search))
+	{
+		return;
+	}
+	Search->Requesters.RemoveAll([&Handle](const FPathRequester& Requester) { return Requester.QueryId == Handle.QueryId; });
+	// If no requester is left waiting for the search, remove it from the queue and return its context to the Grid pool
+	if (Search->Requesters.IsEmpty())
+	{
+		if (Search->Context && Pathfinder && Pathfinder->Grid)
+		{
+			Pathfinder->Grid->GetQueryContextPool().Release(MoveTemp(Search->Context));
+		}
+		SearchesByCells.Remove(GetCellsKey(Search->StartCell, Search->TargetCell));
+		Searches.RemoveAll([Search](const TUniquePtr<FScheduledPathSearch>& QueuedSearch) { return QueuedSearch.Get() == Search; });
+	}
+}
+
+int32 UPathRequestScheduler::GetQueueDepth() const
+{
+	return Searches.Num();
+}
+
+double UPathRequestScheduler::GetAverageWaitTimeMs() const
+{
+	return Stats.NumCompleted > 0 ? Stats.TotalWaitTimeMs / Stats.NumCompleted : 0.0;
+}
+
+const FPathSchedulerStats& UPathRequestScheduler::GetStats() const
+{
+	return Stats;
+}
+
+void UPathRequestScheduler::CompleteSearch(FScheduledPathSearch& Search, EPathSearchStatus Status, TArray<int32>&& Path)
+{
+	// Return the search context to the Grid pool and add the result to the path cache, searches answered by the cache have no context and analyzed no cells
+	int32 NumAnalyzedCells = 0;
+	if (Search.Context)
+	{
+		NumAnalyzedCells = Search.Context->GetNumAnalyzed();
+		FPathfindingStats::RecordQuery(*Search.Context, Search.SearchTimeMs, Status == EPathSearchStatus::PathFound);
+		Pathfinder->Grid->GetQueryContextPool().Release(MoveTemp(Search.Context));
+		if (Pathfinder->bUsePathCache)
+		{
+			Pathfinder->Grid->GetPathCache().Add(Pathfinder->GetPathCacheKey(Search.StartCell, Search.TargetCell, Search.GridVersion, false), Path);
+		}
+	}
+	// Bake the tiles of the unknown cells of the path, the result is flagged for repath once they changed
+	if (Pathfinder->bRequestMissingTiles)
+	{
+		Pathfinder->Grid->RequestTilesForCells(Path);
+	}
+	// Remove the search and its requesters from the lookup maps, so they can't be cancelled while being delivered
+	SearchesByCells.Remove(GetCellsKey(Search.StartCell, Search.TargetCell));
+	for (const FPathRequester& Requester : Search.Requesters)
+	{
+		SearchesByQueryId.Remove(Requester.QueryId);
+	}
+	// Build the result shared by all requesters
+	FPathQueryResult Result;
+	Result.StartCell = Search.StartCell;
+	Result.TargetCell = Search.TargetCell;
+	Result.bPathFound = Status == EPathSearchStatus::PathFound;
+	Result.Path = MoveTemp(Path);
+	Result.SearchTimeMs = Search.SearchTimeMs;
+	Result.NumAnalyzedCells = NumAnalyzedCells;
+	Result.GridVersion = Search.GridVersion;
+	Result.bNeedsRepath = Pathfinder->IsPathOutdated(Result.Path, Search.GridVersion);
+	if (Pathfinder->bSmoothPath)
+	{
+		Pathfinder->SmoothPath(Result.Path, Result.Waypoints);
+	}
+	// Execute the delegate of each requester with its own wait time, and add the wait times to the statistics
+	double CompleteTime = FPlatformTime::Seconds();
+	for (FPathRequester& Requester : Search.Requesters)
+	{
+		Result.WaitTimeMs = (CompleteTime - Requester.RequestTime) * 1000.0;
+		Stats.NumCompleted++;
+		Stats.TotalWaitTimeMs += Result.WaitTimeMs;
+		Stats.MaxWaitTimeMs = FMath::Max(Stats.MaxWaitTimeMs, Result.WaitTimeMs);
+		Requester.OnComplete.ExecuteIfBound(Result);
+	}
+}
+
+uint64 UPathRequestScheduler::GetCellsKey(int32 StartCell, int32 TargetCell)
+{
+	return (uint64(uint32(StartCell)) << 32) | uint64(uint32(TargetCell));
+}
@@ -2,8 +2,11 @@
 
 
 #include "Pathfinder.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Algo/Reverse.h"
+#include "Async/Async.h"
+#include "Misc/ScopeRWLock.h"
+#include "OctileDistance.h"
+#include "PathfindingStats.h"
 
 // Sets default values for this component's properties
 UPathfinder::UPathfinder()
@@ -12,155 +15,911 @@ UPathfinder::UPathfinder()
 	Grid = nullptr;
 }
 
+void UPathfinder::BeginPlay()
+{
+	Super::BeginPlay();
+	// Listen to walkable state changes of the Grid, to flag the current path when an obstacle moves onto it
+	if (Grid)
+	{
+		BoundGrid = Grid;
+		BoundGrid->OnGridRegionChanged.AddUObject(this, &UPathfinder::OnGridRegionChanged);
+		BoundGrid->OnGridCreated.AddUObject(this, &UPathfinder::OnGridCreated);
+	}
+}
+
 void UPathfinder::FindPath(FVector StartPos, FVector TargetPos)
 {
-	// Calculate Start and target nodes from start and target positions
-	AGridNode* StartNode = Grid->NodeFromLocation(StartPos);
-	AGridNode* TargetNode = Grid->NodeFromLocation(TargetPos);
-	// If both start and end nodes are valid, call the FindPathNode with them
-	if (StartNode != nullptr && TargetNode != nullptr)
+	// Calculate Start and target cells from start and target positions
+	int32 StartCell = Grid->CellFromLocation(StartPos);
+	int32 TargetCell = Grid->CellFromLocation(TargetPos);
+	// If both start and end cells are valid, call the FindPathCell with them
+	if (StartCell != INDEX_NONE && TargetCell != INDEX_NONE)
 	{
-		FindPathNode(StartNode, TargetNode);
+		FindPathCell(StartCell, TargetCell);
 	}
 }
 
 void UPathfinder::FindPathNode(AGridNode* StartNode, AGridNode* TargetNode)
 {
-	// Get start time in milliseconds by getting time in seconds and multiplying by 1000
-	double startTime = FPlatformTime::Seconds() * 1000.0f;
+	// Ensure Grid isn't nullptr before operation
+	if (Grid == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return;
+	}
+	// Find the path between the cells the input nodes are visualizing
+	FindPathCell(Grid->GetCellIndex(StartNode->GetGridIndexX(), StartNode->GetGridIndexY()), Grid->GetCellIndex(TargetNode->GetGridIndexX(), TargetNode->GetGridIndexY()));
+}
+
+bool UPathfinder::FindPathCell(int32 StartCell, int32 TargetCell)
+{
 	// Reset previous path using the function for that
 	ResetLastPath();
 	// Ensure Grid isn't nullptr before operation
 	if (Grid == nullptr)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return false;
+	}
+	// Cells outside the Grid have no records in the search context
+	if (!AreCellsInGrid(StartCell, TargetCell))
+	{
+		return false;
+	}
+	// Take a search context from the Grid pool for this query, it's returned to the pool when the function returns
+	// The time and analyzed cells of the query are recorded in the Pathfinding stats by SearchPath
+	FScopedPathQueryContext Context(Grid->GetQueryContextPool());
+	if (!SearchPath(Context.Get(), StartCell, TargetCell, CurrentPath))
+	{
+		return false;
+	}
+	// Show the found path on the Grid, and bake the tiles of its unknown cells
+	HighlightCurrentPath();
+	if (bRequestMissingTiles)
+	{
+		Grid->RequestTilesForCells(CurrentPath);
+	}
+	return true;
+}
+
+bool UPathfinder::FindPathCellIncremental(int32 StartCell, int32 TargetCell)
+{
+	double startTime = FPlatformTime::Seconds() * 1000.0f;
+	ResetLastPath();
+	// Ensure Grid isn't nullptr before operation
+	if (Grid == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return false;
+	}
+	// Cells outside the Grid would index past the per-cell arrays of the planner
+	if (!AreCellsInGrid(StartCell, TargetCell))
+	{
+		return false;
+	}
+	// Keep the search tree if the target is the same, only moving the start, else start a new tree rooted at the new target
+	if (IncrementalPlanner.IsInitialized(Grid->GetNumCells()) && IncrementalPlanner.GetTargetCell() == TargetCell)
+	{
+		IncrementalPlanner.SetStartCell(StartCell);
+	}
+	else
+	{
+		IncrementalPlanner.Initialize(*Grid, StartCell, TargetCell);
+	}
+	if (!IncrementalPlanner.Plan(CurrentPath))
+	{
+		return false;
+	}
+	// Show the found path on the Grid, and print to the verbose log the time it took and the number of cells expanded to repair the tree
+	HighlightCurrentPath();
+	if (bRequestMissingTiles)
+	{
+		Grid->RequestTilesForCells(CurrentPath);
+	}
+	double endTime = FPlatformTime::Seconds() * 1000.0f;
+	UE_LOG(LogTemp, Verbose, TEXT("Incremental planner found a path in %f milliseconds, %i cells expanded"), (endTime - startTime), IncrementalPlanner.GetNumExpanded());
+	return true;
+}
+
+FPathQueryHandle UPathfinder::FindPathAsync(FVector StartPos, FVector TargetPos, FOnPathQueryComplete OnComplete)
+{
+	// Ensure Grid isn't nullptr before operation
+	if (Grid == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return FPathQueryHandle();
+	}
+	// Calculate Start and target cells from start and target positions, and start the query if both are valid
+	int32 StartCell = Grid->CellFromLocation(StartPos);
+	int32 TargetCell = Grid->CellFromLocation(TargetPos);
+	if (StartCell == INDEX_NONE || TargetCell == INDEX_NONE)
+	{
+		return FPathQueryHandle();
+	}
+	return FindPathCellAsync(StartCell, TargetCell, MoveTemp(OnComplete));
+}
+
+FPathQueryHandle UPathfinder::FindPathCellAsync(int32 StartCell, int32 TargetCell, FOnPathQueryComplete OnComplete)
+{
+	// Ensure Grid isn't nullptr before operation
+	if (Grid == nullptr)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Grid Variable not set"));
+		return FPathQueryHandle();
+	}
+	// Reject cells outside the Grid here on the game thread, the worker would read past the cell buffers
+	if (!AreCellsInGrid(StartCell, TargetCell))
+	{
+		return FPathQueryHandle();
+	}
+	// Register the query with a new id and its own cancel flag
+	uint32 QueryId = NextQueryId++;
+	if (NextQueryId == 0)
+	{
+		NextQueryId = 1;
+	}
+	TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> bCancelled = MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+	// Run the search on a task graph worker, the worker only reads the Grid and uses its own context from the Grid pool
+	// EndPlay waits for all tasks before the pathfinder is destroyed, so the task can use this pathfinder directly
+	TWeakObjectPtr<UPathfinder> WeakThis(this);
+	UE::Tasks::FTask Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, WeakThis, QueryId, StartCell, TargetCell, bCancelled]()
+	{
+		FPathQueryResult Result;
+		Result.StartCell = StartCell;
+		Result.TargetCell = TargetCell;
+		double StartTime = FPlatformTime::Seconds();
+		Result.GridVersion = Grid->GetGridVersion();
+		{
+			FScopedPathQueryContext Context(Grid->GetQueryContextPool());
+			Result.bPathFound = SearchPath(Context.Get(), StartCell, TargetCell, Result.Path, &bCancelled.Get());
+			Result.NumAnalyzedCells = Context.Get().GetNumAnalyzed();
+		}
+		// Smooth the path on this worker too, so the game thread only receives the waypoints
+		if (bSmoothPath)
+		{
+			SmoothPath(Result.Path, Result.Waypoints);
+		}
+		Result.SearchTimeMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		// Hand the result back to the game thread, the pathfinder could be destroyed by the time it runs
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, QueryId, Result = MoveTemp(Result)]() mutable
+		{
+			if (UPathfinder* Pathfinder = WeakThis.Get())
+			{
+				Pathfinder->CompletePathQuery(QueryId, MoveTemp(Result));
+			}
+		});
+	});
+	PendingQueries.Add(QueryId, FPendingPathQuery{ Task, bCancelled, MoveTemp(OnComplete), FPlatformTime::Seconds() });
+	return FPathQueryHandle{ QueryId };
+}
+
+bool UPathfinder::AreCellsInGrid(int32 StartCell, int32 TargetCell) const
+{
+	return StartCell >= 0 && StartCell < Grid->GetNumCells() && TargetCell >= 0 && TargetCell < Grid->GetNumCells();
+}
+
+void UPathfinder::CancelPathQuery(FPathQueryHandle Handle)
+{
+	// Set the cancel flag so the search stops, the query is removed once its worker task reports back
+	if (FPendingPathQuery* Query = PendingQueries.Find(Handle.QueryId))
+	{
+		Query->bCancelled->store(true, std::memory_order_relaxed);
+		Query->OnComplete.Unbind();
+	}
+}
+
+void UPathfinder::CancelAllPathQueries()
+{
+	for (auto& Pair : PendingQueries)
+	{
+		Pair.Value.bCancelled->store(true, std::memory_order_relaxed);
+		Pair.Value.OnComplete.Unbind();
+	}
+}
+
+bool UPathfinder::IsPathQueryPending(FPathQueryHandle Handle) const
+{
+	const FPendingPathQuery* Query = PendingQueries.Find(Handle.QueryId);
+	return Query != nullptr && !Query->bCancelled->load(std::memory_order_relaxed);
+}
+
+int32 UPathfinder::GetNumPendingPathQueries() const
+{
+	int32 NumPending = 0;
+	for (const auto& Pair : PendingQueries)
+	{
+		if (!Pair.Value.bCancelled->load(std::memory_order_relaxed))
+		{
+			NumPending++;
+		}
+	}
+	return NumPending;
+}
+
+void UPathfinder::CompletePathQuery(uint32 QueryId, FPathQueryResult&& Result)
+{
+	// Remove the query, and execute its delegate with the result if it wasn't cancelled
+	FPendingPathQuery* Query = PendingQueries.Find(QueryId);
+	if (Query == nullptr)
+	{
 		return;
 	}
-	// Create TArrays of GridNodes to store OpenNodes and Analyzed nodes
-	TArray<AGridNode*> OpenNodes;
-	TArray<AGridNode*> AnalyzedNodes;
-	// Set g_cost and h_cost of the start node and add it to OpenNodes array
-	StartNode->Setg_cost(0);
-	StartNode->Seth_cost(GetDistanceBetweenNodes(StartNode, TargetNode));
-	OpenNodes.Add(StartNode);
-	// Iteratre while there are still OpenNodes available in the array
-	while (!OpenNodes.IsEmpty())
-	{
-		// Initalize curretnNode to be first node in OpenNodes
-		AGridNode* CurrentNode = OpenNodes[0];
-		// Iterate over all OpenNodes and get node with the smallest f_cost, if more than one node have same f_cost, get the one with the smallest h_cost, set it as currentNode
-		for (auto& Node : OpenNodes)
-		{
-			if (Node->Getf_cost() < CurrentNode->Getf_cost() || (Node->Getf_cost() == CurrentNode->Getf_cost() && Node->Geth_cost() < CurrentNode->Geth_cost()))
+	bool bWasCancelled = Query->bCancelled->load(std::memory_order_relaxed);
+	FOnPathQueryComplete OnComplete = MoveTemp(Query->OnComplete);
+	Result.WaitTimeMs = (FPlatformTime::Seconds() - Query->RequestTime) * 1000.0;
+	// Check the path against the cells changed since the search started, including changes made while the result was on its way
+	Result.bNeedsRepath = IsPathOutdated(Result.Path, Result.GridVersion);
+	PendingQueries.Remove(QueryId);
+	if (!bWasCancelled)
+	{
+		// Bake the tiles of the unknown cells of the path, the result is flagged for repath once they changed
+		if (bRequestMissingTiles && Grid)
+		{
+			Grid->RequestTilesForCells(Result.Path);
+		}
+		OnComplete.ExecuteIfBound(Result);
+	}
+}
+
+void UPathfinder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Stop listening to the Grid
+	if (BoundGrid)
+	{
+		BoundGrid->OnGridRegionChanged.RemoveAll(this);
+		BoundGrid->OnGridCreated.RemoveAll(this);
+		BoundGrid = nullptr;
+	}
+	// Cancel all running queries and wait for their worker tasks, so no task uses this pathfinder after it's destroyed
+	CancelAllPathQueries();
+	TArray<UE::Tasks::FTask> Tasks;
+	for (const auto& Pair : PendingQueries)
+	{
+		Tasks.Add(Pair.Value.Task);
+	}
+	UE::Tasks::Wait(Tasks);
+	PendingQueries.Empty();
+	Super::EndPlay(EndPlayReason);
+}
+
+bool UPathfinder::SearchPath(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	PATHFINDING_SCOPE(STAT_PathfindingSearch);
+	double StartTime = FPlatformTime::Seconds();
+	bool bPathFound;
+	// Hold the Grid cell data lock for reading through the whole query, so the version, the cache key and the searched cells all belong to the same Grid
+	FReadScopeLock CellDataLock(Grid->GetCellDataLock());
+	if (!bUsePathCache)
+	{
+		bPathFound = SearchPathUncached(Context, StartCell, TargetCell, OutPath, bCancelled);
+	}
+	else
+	{
+		// Return the cached result if the same query was searched on the current Grid version, starting an empty query in the context so it reports no analyzed cells
+		FPathCacheKey CacheKey = GetPathCacheKey(StartCell, TargetCell, Grid->GetGridVersion(), true);
+		if (Grid->GetPathCache().Find(CacheKey, OutPath))
+		{
+			Context.BeginQuery(Grid->GetNumCells(), StartCell, TargetCell);
+			bPathFound = !OutPath.IsEmpty();
+		}
+		else
+		{
+			// Cache the result of the search, unless it was cancelled before finishing, an empty path is cached when no path exists
+			bPathFound = SearchPathUncached(Context, StartCell, TargetCell, OutPath, bCancelled);
+			if (bCancelled == nullptr || !bCancelled->load(std::memory_order_relaxed))
 			{
-				CurrentNode = Node;
+				Grid->GetPathCache().Add(CacheKey, OutPath);
 			}
 		}
-		// Remove CurrentNode from OpenNodes and add it to AnalyzedNode
-		OpenNodes.Remove(CurrentNode);
-		AnalyzedNodes.Add(CurrentNode);
-		// If CurrentNode equals TargetNode, we have reached the target so we can start retracing the path
-		if (CurrentNode == TargetNode)
+	}
+	// Add the counters and latency of the query to the pathfinding stats
+	FPathfindingStats::RecordQuery(Context, (FPlatformTime::Seconds() - StartTime) * 1000.0, bPathFound);
+	return bPathFound;
+}
+
+FPathCacheKey UPathfinder::GetPathCacheKey(int32 StartCell, int32 TargetCell, uint32 GridVersion, bool bHierarchical) const
+{
+	// Jump point search falls back to A* on weighted grids, and the cluster graph is only used for long queries if it's built, so the variant is the algorithm that actually runs
+	// The query distance is checked against HierarchicalMinDistance like SearchPathUncached does, so changing it doesn't return paths found with the other algorithm
+	bool bJumpPointSearch = SearchMode == EPathSearchMode::JumpPointSearch && Grid->CanUseJumpPointSearch();
+	bool bClusterGraph = bHierarchical && bUseHierarchicalSearch && Grid->GetClusterGraph().IsBuilt() && IsHierarchicalQuery(StartCell, TargetCell);
+	bool bAnyAngle = SearchMode == EPathSearchMode::ThetaStar;
+	bool bBidirectional = bHierarchical && bUseBidirectionalSearch && !bJumpPointSearch && !bAnyAngle;
+	uint8 SearchVariant = (bJumpPointSearch ? 1 : 0) | (bClusterGraph ? 2 : 0) | (bBidirectional ? 4 : 0) | (bAnyAngle ? 8 : 0);
+	return FPathCacheKey{ StartCell, TargetCell, GridVersion, SearchVariant };
+}
+
+bool UPathfinder::IsHierarchicalQuery(int32 StartCell, int32 TargetCell) const
+{
+	int32 DistanceX = FMath::Abs(Grid->GetCellX(TargetCell) - Grid->GetCellX(StartCell));
+	int32 DistanceY = FMath::Abs(Grid->GetCellY(TargetCell) - Grid->GetCellY(StartCell));
+	return FMath::Max(DistanceX, DistanceY) >= HierarchicalMinDistance;
+}
+
+bool UPathfinder::SearchPathUncached(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	// Search long queries on the cluster graph of the Grid if it's built, SearchPath holds the cell data lock for reading
+	if (bUseHierarchicalSearch && Grid->GetClusterGraph().IsBuilt() && IsHierarchicalQuery(StartCell, TargetCell))
+	{
+		if (Grid->GetClusterGraph().FindPath(*Grid, Context, StartCell, TargetCell, OutPath, bCancelled))
+		{
+			return true;
+		}
+		// Entrances only pair straight openings between clusters, so a route through a diagonal gap can be missed, fall back to the full search below
+		if (bCancelled != nullptr && bCancelled->load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+	}
+	// Search from both ends if it's enabled and the Grid is searched with A*, jump point search already skips most cells of open routes
+	bool bJumpPointSearch = SearchMode == EPathSearchMode::JumpPointSearch && Grid->CanUseJumpPointSearch();
+	if (bUseBidirectionalSearch && !bJumpPointSearch && SearchMode != EPathSearchMode::ThetaStar)
+	{
+		return SearchPathBidirectional(Context, StartCell, TargetCell, OutPath, bCancelled);
+	}
+	// Start the search and advance it without limit until it finishes
+	BeginSearchLocked(Context, StartCell, TargetCell);
+	return StepSearchLocked(Context, MAX_int32, OutPath, bCancelled) == EPathSearchStatus::PathFound;
+}
+
+bool UPathfinder::SearchPathBidirectional(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	// The backward side searches from the target cell towards the start cell in its own context, moves cost the same in both directions so it uses the same neighbor expansion
+	FScopedPathQueryContext BackwardContext(Grid->GetQueryContextPool());
+	FPathQueryContext& Backward = BackwardContext.Get();
+	BeginSearchLocked(Context, StartCell, TargetCell);
+	BeginSearchLocked(Backward, TargetCell, StartCell);
+	OutPath.Reset();
+	// Cost of the cheapest path found so far through a cell reached by both sides, and that cell
+	int32 BestCost = StartCell == TargetCell ? 0 : MAX_int32;
+	int32 MeetingCell = StartCell == TargetCell ? StartCell : INDEX_NONE;
+	FNodeHeap& ForwardOpenNodes = Context.GetOpenNodes();
+	FNodeHeap& BackwardOpenNodes = Backward.GetOpenNodes();
+	// If either open set is empty, every cell its side can reach was analyzed, so the sides already met if a path exists
+	while (!ForwardOpenNodes.IsEmpty() && !BackwardOpenNodes.IsEmpty())
+	{
+		// Stop the search if the query was cancelled
+		if (bCancelled != nullptr && bCancelled->load(std::memory_order_relaxed))
+		{
+			Context.AddBackwardQuery(Backward);
+			return false;
+		}
+		// Every path not found yet crosses a cell in each open set, and the smallest f_cost of an open set never overestimates the cost of the paths crossing it
+		// So once either smallest f_cost reaches the best cost, no cheaper path exists
+		int32 Forwardf_cost, Backwardf_cost, Unusedh_cost;
+		ForwardOpenNodes.GetTopCosts(Forwardf_cost, Unusedh_cost);
+		BackwardOpenNodes.GetTopCosts(Backwardf_cost, Unusedh_cost);
+		if (FMath::Max(Forwardf_cost, Backwardf_cost) >= BestCost)
+		{
+			break;
+		}
+		// Expand the side with fewer open cells, which keeps both searches small on open routes
+		bool bForward = ForwardOpenNodes.Num() <= BackwardOpenNodes.Num();
+		FPathQueryContext& Side = bForward ? Context : Backward;
+		const FPathQueryContext& OtherSide = bForward ? Backward : Context;
+		int32 CurrentCell = Side.GetOpenNodes().Pop();
+		Side.SetAnalyzed(CurrentCell);
+		AddNeighborCells(Side, CurrentCell);
+		// Check the cells whose g_cost this side may have just lowered for a cheaper path through a cell the other side reached
+		auto CheckMeeting = [&Side, &OtherSide, &BestCost, &MeetingCell](int32 Cell)
 		{
-			// Set the CurrentPath Array
-			CurrentPath = RetracePath(StartNode, TargetNode);
-			// Change the color of StartNode to green, TargetNode to yellow, all path nodes to black and set the nodes visible
-			for (auto& Node : CurrentPath)
+			if (Side.IsVisited(Cell) && OtherSide.IsVisited(Cell))
 			{
-				if (Node == StartNode)
-				{
-					Node->ChangeColor(FColor::Green, 1.0f);
-				}
-				else if (Node == TargetNode)
+				int32 PathCost = Side.Getg_cost(Cell) + OtherSide.Getg_cost(Cell);
+				if (PathCost < BestCost)
 				{
-					Node->ChangeColor(FColor::Yellow, 1.0f);
+					BestCost = PathCost;
+					MeetingCell = Cell;
 				}
-				else
+			}
+		};
+		CheckMeeting(CurrentCell);
+		Grid->ForEachNeighborCell(CurrentCell, CheckMeeting);
+	}
+	Context.AddBackwardQuery(Backward);
+	if (MeetingCell == INDEX_NONE)
+	{
+		return false;
+	}
+	// Join the forward path to the meeting cell with the backward parents, which lead from the meeting cell to the target cell one neighbor at a time
+	RetracePath(Context, StartCell, MeetingCell, OutPath);
+	for (int32 Cell = MeetingCell; Cell != TargetCell; )
+	{
+		Cell = Backward.GetParentCell(Cell);
+		OutPath.Add(Cell);
+	}
+	return true;
+}
+
+void UPathfinder::BeginSearch(FPathQueryContext& Context, int32 StartCell, int32 TargetCell) const
+{
+	// Hold the Grid cell data lock for reading, so the context is sized for the cells the start cell is read from
+	FReadScopeLock CellDataLock(Grid->GetCellDataLock());
+	BeginSearchLocked(Context, StartCell, TargetCell);
+}
+
+void UPathfinder::BeginSearchLocked(FPathQueryContext& Context, int32 StartCell, int32 TargetCell) const
+{
+	// Start a new query in the context, all cell records of its last query become invalid
+	Context.BeginQuery(Grid->GetNumCells(), StartCell, TargetCell);
+	// Set g_cost and h_cost of the start cell and add it to OpenNodes heap, the distance is scaled by the cheapest cell cost so it never overestimates
+	Context.Visit(StartCell, 0, GetDistanceBetweenCells(StartCell, TargetCell) * Grid->GetMinCellCost(), INDEX_NONE);
+	Context.GetOpenNodes().Add(StartCell, Context.Getf_cost(StartCell), Context.Geth_cost(StartCell));
+	Context.UpdatePeakOpenNodes(1);
+}
+
+EPathSearchStatus UPathfinder::StepSearch(FPathQueryContext& Context, int32 MaxIterations, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	// Hold the Grid cell data lock for reading, so the cell buffers aren't rebaked while the search reads them
+	FReadScopeLock CellDataLock(Grid->GetCellDataLock());
+	return StepSearchLocked(Context, MaxIterations, OutPath, bCancelled);
+}
+
+EPathSearchStatus UPathfinder::StepSearchLocked(FPathQueryContext& Context, int32 MaxIterations, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const
+{
+	PATHFINDING_SCOPE(STAT_PathfindingSearchStep);
+	// If the Grid was recreated with a different size since the search started, the records in the context no longer match its cells
+	if (Context.GetNumCells() != Grid->GetNumCells())
+	{
+		OutPath.Reset();
+		return EPathSearchStatus::NoPath;
+	}
+	FNodeHeap& OpenNodes = Context.GetOpenNodes();
+	int32 TargetCell = Context.GetTargetCell();
+	// Iteratre while there are still OpenNodes available in the heap, analyzing at most MaxIterations cells
+	for (int32 Iteration = 0; Iteration < MaxIterations && !OpenNodes.IsEmpty(); Iteration++)
+	{
+		// Stop the search if the query was cancelled
+		if (bCancelled != nullptr && bCancelled->load(std::memory_order_relaxed))
+		{
+			OutPath.Reset();
+			return EPathSearchStatus::Cancelled;
+		}
+		// Pop the cell with the smallest f_cost from the heap, if more than one cell have same f_cost, the heap returns the one with the smallest h_cost, set it as CurrentCell
+		int32 CurrentCell = OpenNodes.Pop();
+		// Mark CurrentCell as analyzed, it was already removed from OpenNodes by the heap
+		Context.SetAnalyzed(CurrentCell);
+		// If CurrentCell equals TargetCell, we have reached the target so we can retrace the path and return
+		if (CurrentCell == TargetCell)
+		{
+			RetracePath(Context, Context.GetStartCell(), TargetCell, OutPath);
+			return EPathSearchStatus::PathFound;
+		}
+		// Add the cells reached from CurrentCell to OpenNodes, every neighbor cell for A* and Theta*, only the jump points for jump point search
+		// Jump point search relies on all moves in a direction costing the same, so grids with weighted cells are searched with A* instead
+		if (SearchMode == EPathSearchMode::ThetaStar)
+		{
+			AddNeighborCellsAnyAngle(Context, CurrentCell);
+		}
+		else if (SearchMode == EPathSearchMode::JumpPointSearch && Grid->CanUseJumpPointSearch())
+		{
+			AddJumpPoints(Context, CurrentCell);
+		}
+		else
+		{
+			AddNeighborCells(Context, CurrentCell);
+		}
+	}
+	// Search isn't finished if there are still cells to analyze, else no path exists, empty the output path
+	if (!OpenNodes.IsEmpty())
+	{
+		return EPathSearchStatus::InProgress;
+	}
+	OutPath.Reset();
+	return EPathSearchStatus::NoPath;
+}
+
+void UPathfinder::AddNeighborCells(FPathQueryContext& Context, int32 CurrentCell) const
+{
+	PATHFINDING_DETAILED_SCOPE(STAT_PathfindingNeighborExpansion);
+	// Gather the neighbor cells of CurrentCell with their X and Y indices and move costs, using the Grid precomputed offsets and border mask
+	int32 NeighborCells[8];
+	int32 IndicesX[8];
+	int32 IndicesY[8];
+	int32 MoveCosts[8];
+	int32 NumNeighbors = 0;
+	int32 CurrentX = Grid->GetCellX(CurrentCell);
+	int32 CurrentY = Grid->GetCellY(CurrentCell);
+	uint8 NeighborMask = Grid->GetNeighborMask(CurrentCell);
+	// The walkable state of every neighbor inside the grid is checked
+	Context.AddWalkabilityLookups(FMath::CountBits(NeighborMask));
+	for (int32 Direction = 0; Direction < 8; Direction++)
+	{
+		int32 Neighbor = CurrentCell + Grid->GetNeighborOffset(Direction);
+		// If a neighbor cell is outside the grid, unwalkable in the baked walkability bitmap or already analyzed, skip it
+		if (!(NeighborMask & (1 << Direction)) || !Grid->IsCellWalkable(Neighbor) || Context.IsAnalyzed(Neighbor))
+		{
+			continue;
+		}
+		NeighborCells[NumNeighbors] = Neighbor;
+		IndicesX[NumNeighbors] = CurrentX + AGrid::NeighborDirectionsX[Direction];
+		IndicesY[NumNeighbors] = CurrentY + AGrid::NeighborDirectionsY[Direction];
+		MoveCosts[NumNeighbors] = Grid->GetMoveCost(CurrentCell, Neighbor, FOctileDistance::GetMoveCost(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]));
+		NumNeighbors++;
+	}
+	// Calculate the h_cost of all gathered neighbors in one batch, scaled by the cheapest cell cost so it never overestimates, then visit them in the same order as the Grid neighbor cells
+	int32 TargetCell = Context.GetTargetCell();
+	int32 HeuristicScale = Grid->GetMinCellCost();
+	int32 Heuristics[8];
+	{
+		PATHFINDING_DETAILED_SCOPE(STAT_PathfindingHeuristic);
+		FOctileDistance::GetBatch(IndicesX, IndicesY, NumNeighbors, Grid->GetCellX(TargetCell), Grid->GetCellY(TargetCell), Heuristics);
+	}
+	for (int32 NeighborIndex = 0; NeighborIndex < NumNeighbors; NeighborIndex++)
+	{
+		VisitCell(Context, CurrentCell, NeighborCells[NeighborIndex], MoveCosts[NeighborIndex], Heuristics[NeighborIndex] * HeuristicScale);
+	}
+}
+
+void UPathfinder::AddNeighborCellsAnyAngle(FPathQueryContext& Context, int32 CurrentCell) const
+{
+	PATHFINDING_DETAILED_SCOPE(STAT_PathfindingNeighborExpansion);
+	// Shortcuts are only taken across the cheapest cells, so their straight line cost is exact
+	int32 ParentCell = Context.GetParentCell(CurrentCell);
+	int32 TargetCell = Context.GetTargetCell();
+	int32 CellCost = Grid->GetMinCellCost();
+	uint8 NeighborMask = Grid->GetNeighborMask(CurrentCell);
+	Context.AddWalkabilityLookups(FMath::CountBits(NeighborMask));
+	for (int32 Direction = 0; Direction < 8; Direction++)
+	{
+		int32 Neighbor = CurrentCell + Grid->GetNeighborOffset(Direction);
+		// If a neighbor cell is outside the grid, unwalkable in the baked walkability bitmap or already analyzed, skip it
+		if (!(NeighborMask & (1 << Direction)) || !Grid->IsCellWalkable(Neighbor) || Context.IsAnalyzed(Neighbor))
+		{
+			continue;
+		}
+		// The straight line distance never overestimates an any-angle path, scaled by the cheapest cell cost like the A* distance
+		int32 h_cost = GetAnyAngleDistance(Neighbor, TargetCell) * CellCost;
+		// Link the neighbor straight to the parent of CurrentCell if the line between them is open, else move to it from CurrentCell like A*
+		if (ParentCell != INDEX_NONE && Grid->HasLineOfSight(ParentCell, Neighbor, CellCost))
+		{
+			VisitCell(Context, ParentCell, Neighbor, GetAnyAngleDistance(ParentCell, Neighbor) * CellCost, h_cost);
+		}
+		else
+		{
+			int32 MoveCost = Grid->GetMoveCost(CurrentCell, Neighbor, FOctileDistance::GetMoveCost(AGrid::NeighborDirectionsX[Direction], AGrid::NeighborDirectionsY[Direction]));
+			VisitCell(Context, CurrentCell, Neighbor, MoveCost, h_cost);
+		}
+	}
+}
+
+int32 UPathfinder::GetAnyAngleDistance(int32 StartCell, int32 EndCell) const
+{
+	PATHFINDING_DETAILED_SCOPE(STAT_PathfindingHeuristic);
+	int32 DistanceX = Grid->GetCellX(EndCell) - Grid->GetCellX(StartCell);
+	int32 DistanceY = Grid->GetCellY(EndCell) - Grid->GetCellY(StartCell);
+	return FMath::FloorToInt(FOctileDistance::StraightCost * FMath::Sqrt(float(DistanceX * DistanceX + DistanceY * DistanceY)));
+}
+
+void UPathfinder::AddJumpPoints(FPathQueryContext& Context, int32 CurrentCell) const
+{
+	PATHFINDING_DETAILED_SCOPE(STAT_PathfindingNeighborExpansion);
+	int32 IndexX = Grid->GetCellX(CurrentCell);
+	int32 IndexY = Grid->GetCellY(CurrentCell);
+	int32 ParentCell = Context.GetParentCell(CurrentCell);
+	// Collect the directions to search from CurrentCell, at most 8
+	FIntPoint Directions[8];
+	int32 NumDirections = 0;
+	if (ParentCell == INDEX_NONE)
+	{
+		// Start cell has no parent, search all 8 directions in the same order as the Grid neighbor cells
+		for (int32 y = -1; y <= 1; y++)
+		{
+			for (int32 x = -1; x <= 1; x++)
+			{
+				if (x != 0 || y != 0)
 				{
-					Node->ChangeColor(FColor::Black, 1.0f);
+					Directions[NumDirections++] = FIntPoint(x, y);
 				}
-				Node->setNodeVisibility(true);
 			}
-			// Get time after algorithm finished executing, print to log the time it took to find the path from start to target, and then return from this function
-			double endTime = FPlatformTime::Seconds() * 1000.0f;
-			UE_LOG(LogTemp, Warning, TEXT("Total Time taken by Algorithm in milliseconds: %f"), (endTime - startTime));
-			return;
 		}
-		// Get all neighbor nodes using the Grid method, as input we use the CurrentNode
-		TArray<AGridNode*> NeighborNodes = Grid->GetNeighborNodes(CurrentNode);
-		for (auto& neighbor : NeighborNodes)
+	}
+	else
+	{
+		// Get the direction of the move from the parent, the parent can be several cells away on a straight or diagonal line
+		int32 DirX = FMath::Sign(IndexX - Grid->GetCellX(ParentCell));
+		int32 DirY = FMath::Sign(IndexY - Grid->GetCellY(ParentCell));
+		if (DirX != 0 && DirY != 0)
 		{
-			// If a neighbor node is unwalkable or already analyzed, skip it
-			if (!neighbor->CheckWalkable() || AnalyzedNodes.Contains(neighbor))
+			// Diagonal move: continue straight in both of its components and diagonally, plus the forced neighbors behind blocked cells
+			Directions[NumDirections++] = FIntPoint(DirX, 0);
+			Directions[NumDirections++] = FIntPoint(0, DirY);
+			Directions[NumDirections++] = FIntPoint(DirX, DirY);
+			if (!Grid->IsWalkable(IndexX - DirX, IndexY))
 			{
-				continue;
+				Directions[NumDirections++] = FIntPoint(-DirX, DirY);
 			}
-			// Calculate new g_cost for each neighbor node from CurrentNode
-			int32 g_costNeighborNew = GetDistanceBetweenNodes(CurrentNode, neighbor) + CurrentNode->Getg_cost();
-			// If calculated g_cost less than old g_cost for neighbor node or neighbor node not in OpenNodes, Change the g_cost of the neighbor node to the calculated one, calculate h_cost for the node, set currentNode to be its parent Node
-			if (g_costNeighborNew < neighbor->Getg_cost() || !OpenNodes.Contains(neighbor))
+			if (!Grid->IsWalkable(IndexX, IndexY - DirY))
 			{
-				neighbor->Setg_cost(g_costNeighborNew);
-				neighbor->Seth_cost(GetDistanceBetweenNodes(neighbor, TargetNode));
-				neighbor->SetParentNode(CurrentNode);
-				// If neighbor node no in OpenNodes, add it to OpenNodes array 
-				if (!OpenNodes.Contains(neighbor))
-				{
-					OpenNodes.Add(neighbor);
-				}
+				Directions[NumDirections++] = FIntPoint(DirX, -DirY);
+			}
+		}
+		else if (DirX != 0)
+		{
+			// Straight move along X: continue straight, plus the forced neighbors beside blocked cells
+			Directions[NumDirections++] = FIntPoint(DirX, 0);
+			if (!Grid->IsWalkable(IndexX, IndexY + 1))
+			{
+				Directions[NumDirections++] = FIntPoint(DirX, 1);
+			}
+			if (!Grid->IsWalkable(IndexX, IndexY - 1))
+			{
+				Directions[NumDirections++] = FIntPoint(DirX, -1);
+			}
+		}
+		else
+		{
+			// Straight move along Y: continue straight, plus the forced neighbors beside blocked cells
+			Directions[NumDirections++] = FIntPoint(0, DirY);
+			if (!Grid->IsWalkable(IndexX + 1, IndexY))
+			{
+				Directions[NumDirections++] = FIntPoint(1, DirY);
+			}
+			if (!Grid->IsWalkable(IndexX - 1, IndexY))
+			{
+				Directions[NumDirections++] = FIntPoint(-1, DirY);
 			}
 		}
 	}
+	// Jump in each direction, and add the reached jump point to OpenNodes if it wasn't analyzed yet
+	int32 TargetCell = Context.GetTargetCell();
+	int32 NumLookups = 0;
+	for (int32 DirectionIndex = 0; DirectionIndex < NumDirections; DirectionIndex++)
+	{
+		const FIntPoint& Direction = Directions[DirectionIndex];
+		int32 JumpPoint = (Direction.X != 0 && Direction.Y != 0)
+			? JumpDiagonal(IndexX, IndexY, Direction.X, Direction.Y, TargetCell, NumLookups)
+			: JumpStraight(IndexX, IndexY, Direction.X, Direction.Y, TargetCell);
+		if (JumpPoint != INDEX_NONE && !Context.IsAnalyzed(JumpPoint))
+		{
+			VisitCell(Context, CurrentCell, JumpPoint);
+		}
+	}
+	Context.AddWalkabilityLookups(NumLookups);
+}
+
+int32 UPathfinder::JumpStraight(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY, int32 TargetCell) const
+{
+	// Read the baked jump distance of the cell in the direction of the move
+	EGridDirection Direction = DirX > 0 ? EGridDirection::East : (DirX < 0 ? EGridDirection::West : (DirY > 0 ? EGridDirection::North : EGridDirection::South));
+	int32 Distance = Grid->GetJumpDistance(Grid->GetCellIndex(IndexX, IndexY), Direction);
+	// The jump distances don't know the target, so check if the target lies on the line within the steps that can be taken
+	int32 TargetX = Grid->GetCellX(TargetCell);
+	int32 TargetY = Grid->GetCellY(TargetCell);
+	int32 TargetSteps = DirX != 0 ? (TargetY == IndexY ? (TargetX - IndexX) * DirX : 0) : (TargetX == IndexX ? (TargetY - IndexY) * DirY : 0);
+	if (TargetSteps > 0 && TargetSteps <= FMath::Abs(Distance))
+	{
+		return TargetCell;
+	}
+	// Positive distance reaches a jump point, else the move hits an unwalkable cell without finding one
+	if (Distance > 0)
+	{
+		return Grid->GetCellIndex(IndexX + DirX * Distance, IndexY + DirY * Distance);
+	}
+	return INDEX_NONE;
+}
+
+int32 UPathfinder::JumpDiagonal(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY, int32 TargetCell, int32& NumLookups) const
+{
+	// Step diagonally until reaching an unwalkable cell, the target, a cell with a forced neighbor, or a cell from which a straight move finds a jump point
+	while (true)
+	{
+		IndexX += DirX;
+		IndexY += DirY;
+		NumLookups++;
+		if (!Grid->IsWalkable(IndexX, IndexY))
+		{
+			return INDEX_NONE;
+		}
+		int32 Cell = Grid->GetCellIndex(IndexX, IndexY);
+		if (Cell == TargetCell || Grid->HasForcedNeighbor(IndexX, IndexY, DirX, DirY))
+		{
+			return Cell;
+		}
+		if (JumpStraight(IndexX, IndexY, DirX, 0, TargetCell) != INDEX_NONE || JumpStraight(IndexX, IndexY, 0, DirY, TargetCell) != INDEX_NONE)
+		{
+			return Cell;
+		}
+	}
+}
+
+void UPathfinder::VisitCell(FPathQueryContext& Context, int32 FromCell, int32 Cell) const
+{
+	// The distance is exact since cells are reached in a straight or diagonal line, and only used by jump point search on grids where all cells have the same cost
+	int32 CellCost = Grid->GetMinCellCost();
+	VisitCell(Context, FromCell, Cell, GetDistanceBetweenCells(FromCell, Cell) * CellCost, GetDistanceBetweenCells(Cell, Context.GetTargetCell()) * CellCost);
+}
+
+void UPathfinder::VisitCell(FPathQueryContext& Context, int32 FromCell, int32 Cell, int32 MoveCost, int32 h_cost) const
+{
+	FNodeHeap& OpenNodes = Context.GetOpenNodes();
+	// Calculate new g_cost for the cell from FromCell
+	int32 g_costNew = MoveCost + Context.Getg_cost(FromCell);
+	// If calculated g_cost less than old g_cost for the cell or the cell not in OpenNodes, Change the g_cost of the cell to the calculated one, set its h_cost, set FromCell to be its parent cell
+	bool bInOpenNodes = OpenNodes.Contains(Cell);
+	if (!bInOpenNodes || g_costNew < Context.Getg_cost(Cell))
+	{
+		Context.Visit(Cell, g_costNew, h_cost, FromCell);
+		// If the cell not in OpenNodes, add it to OpenNodes heap, else move it up the heap to match its decreased cost
+		if (!bInOpenNodes)
+		{
+			OpenNodes.Add(Cell, Context.Getf_cost(Cell), Context.Geth_cost(Cell));
+			Context.UpdatePeakOpenNodes(OpenNodes.Num());
+		}
+		else
+		{
+			OpenNodes.Update(Cell, Context.Getf_cost(Cell), Context.Geth_cost(Cell));
+		}
+	}
 }
 
 int32 UPathfinder::GetDistanceBetweenNodes(const AGridNode* StartNode, const AGridNode* EndNode)
 {
-	
-	// Get distance between the 2 nodes in the X direction
-	int32 DistanceX = UKismetMathLibrary::Abs_Int(EndNode->GetGridIndexX() - StartNode->GetGridIndexX());
-	// Get distance between the 2 nodes in the Y direction 
-	int32 DistanceY = UKismetMathLibrary::Abs_Int(EndNode->GetGridIndexY() - StartNode->GetGridIndexY());
-	int32 distance;
-	// The direct unobstructed path between 2 nodes will be number of diagonal moves equal to min(DistanceX,DistanceY) then either vertical or horizontal moves equal to max(DistanceX,DistanceY) - min(DistanceX,DistanceY) 
-	// Each diagonal move has a cost of 14 and each horizontal or vertical move has a cost of 10 (Assuming square of length = 1, Distance in V or H direction = 1, Distance in Diagonal direction = sqrt(2) =~ 1.4, for simplicity are made to be 10 and 14 respectively)
-	if (DistanceX < DistanceY)
+	// The direct unobstructed path between 2 nodes will be number of diagonal moves equal to min(DistanceX,DistanceY) then either vertical or horizontal moves equal to max(DistanceX,DistanceY) - min(DistanceX,DistanceY)
+	return FOctileDistance::Get(EndNode->GetGridIndexX() - StartNode->GetGridIndexX(), EndNode->GetGridIndexY() - StartNode->GetGridIndexY());
+}
+
+int32 UPathfinder::GetDistanceBetweenCells(int32 StartCell, int32 EndCell) const
+{
+	// Same distance as GetDistanceBetweenNodes, using the X and Y indices of the cells
+	return FOctileDistance::Get(Grid->GetCellX(EndCell) - Grid->GetCellX(StartCell), Grid->GetCellY(EndCell) - Grid->GetCellY(StartCell));
+}
+
+void UPathfinder::GetDistancesToCell(TArrayView<const int32> Cells, int32 TargetCell, TArrayView<int32> OutDistances) const
+{
+	check(OutDistances.Num() >= Cells.Num());
+	// Unpack the X and Y indices of the cells in chunks on the stack, and evaluate each chunk in one batch
+	constexpr int32 ChunkSize = 64;
+	int32 IndicesX[ChunkSize];
+	int32 IndicesY[ChunkSize];
+	int32 TargetX = Grid->GetCellX(TargetCell);
+	int32 TargetY = Grid->GetCellY(TargetCell);
+	for (int32 ChunkStart = 0; ChunkStart < Cells.Num(); ChunkStart += ChunkSize)
 	{
-		distance = DistanceX * 14 + (DistanceY - DistanceX) * 10;
+		int32 NumInChunk = FMath::Min(ChunkSize, Cells.Num() - ChunkStart);
+		for (int32 Index = 0; Index < NumInChunk; Index++)
+		{
+			IndicesX[Index] = Grid->GetCellX(Cells[ChunkStart + Index]);
+			IndicesY[Index] = Grid->GetCellY(Cells[ChunkStart + Index]);
+		}
+		FOctileDistance::GetBatch(IndicesX, IndicesY, NumInChunk, TargetX, TargetY, OutDistances.GetData() + ChunkStart);
 	}
-	else
+}
+
+void UPathfinder::RetracePath(const FPathQueryContext& Context, int32 StartCell, int32 EndCell, TArray<int32>& OutPath) const
+{
+	PATHFINDING_SCOPE(STAT_PathfindingRetrace);
+	// Empty the output array keeping its memory, and add the end cell to it
+	OutPath.Reset();
+	OutPath.Add(EndCell);
+	// Set initialy the CurrentCell to be EndCell
+	int32 CurrentCell = EndCell;
+	// Change CurrentCell to its parent as long as it doens't equal StartCell
+	while (CurrentCell != StartCell)
 	{
-		distance = DistanceY * 14 + (DistanceX - DistanceY) * 10;
+		// Walk the line from CurrentCell to its parent adding each cell in the path to the PathArray, jump point search and Theta* parents can be several cells away
+		// The walk crosses the same cells the Theta* line of sight check did, and steps straight or diagonally towards jump point search parents
+		int32 ParentCell = Context.GetParentCell(CurrentCell);
+		Grid->ForEachCellOnLine(CurrentCell, ParentCell, [&OutPath](int32 Cell)
+		{
+			OutPath.Add(Cell);
+			return true;
+		});
+		CurrentCell = ParentCell;
 	}
-	return distance;
+	// Reverse the output array to be in the correct order from StartCell to EndCell
+	Algo::Reverse(OutPath);
 }
 
-TArray<AGridNode*> UPathfinder::RetracePath(const AGridNode* StartNode, AGridNode* EndNode)
+void UPathfinder::SmoothPath(const TArray<int32>& Path, TArray<int32>& OutWaypoints) const
 {
-	// Create TArray to store GridNodes on path
-	TArray<AGridNode*> PathNodes;
-	// Add the end node to the PathNodes array 
-	PathNodes.Add(EndNode);
-	// Set initialy the currentnode pointer to point at EndNode
-	AGridNode* CurrentNode = EndNode;
-	// Change CurrentNode to its parent as long as it doens't equal startNode
-	while (CurrentNode != StartNode)
+	PATHFINDING_SCOPE(STAT_PathfindingSmoothPath);
+	OutWaypoints.Reset();
+	if (Path.IsEmpty())
+	{
+		return;
+	}
+	// Hold the Grid cell data lock for reading, so the walkability bitmap isn't rebaked during the line of sight checks
+	FReadScopeLock CellDataLock(Grid->GetCellDataLock());
+	// Pull the string from each waypoint as far along the path as the line of sight reaches, consecutive path cells are always kept since the search moved between them
+	OutWaypoints.Add(Path[0]);
+	int32 AnchorIndex = 0;
+	uint8 MaxPathCost = Grid->GetCellCost(Path[0]);
+	for (int32 PathIndex = 1; PathIndex < Path.Num(); PathIndex++)
 	{
-		CurrentNode = CurrentNode->GetParentNode();
-		// Add each node in the path to the PathArray
-		PathNodes.Add(CurrentNode);
+		MaxPathCost = FMath::Max(MaxPathCost, Grid->GetCellCost(Path[PathIndex]));
+		if (PathIndex - AnchorIndex > 1 && !Grid->HasLineOfSight(Path[AnchorIndex], Path[PathIndex], MaxPathCost))
+		{
+			// The previous cell is the furthest one in sight, it becomes the next waypoint and the anchor of the next line
+			AnchorIndex = PathIndex - 1;
+			OutWaypoints.Add(Path[AnchorIndex]);
+			MaxPathCost = FMath::Max(Grid->GetCellCost(Path[AnchorIndex]), Grid->GetCellCost(Path[PathIndex]));
+		}
+	}
+	if (Path.Num() > 1)
+	{
+		OutWaypoints.Add(Path.Last());
 	}
-	// Reverse the PathArray to be in the correct order from StartNode to EndNode
-	Algo::Reverse(PathNodes);
-	return PathNodes;
 }
 
 void UPathfinder::ResetLastPath()
 {
-	// Iterate over all nodes on current path array, and set set to invisible and change their color to the default color
-	for (auto& Node : CurrentPath)
+	// Iterate over all cells on current path array, and set set to invisible and change their color to the default color
+	for (int32 Cell : CurrentPath)
+	{
+		Grid->ResetCellHighlight(Cell);
+	}
+	CurrentPath.Reset();
+	bCurrentPathNeedsRepath = false;
+}
+
+const TArray<int32>& UPathfinder::GetCurrentPath() const
+{
+	return CurrentPath;
+}
+
+void UPathfinder::ShowPath(const TArray<int32>& Path)
+{
+	// Reset the last path, then set the input path as current path and show it on the Grid
+	ResetLastPath();
+	CurrentPath = Path;
+	HighlightCurrentPath();
+}
+
+bool UPathfinder::IsPathOutdated(const TArray<int32>& Path, uint32 GridVersion) const
+{
+	// Without a path, any change could have opened one
+	if (Path.IsEmpty())
+	{
+		return Grid->GetGridVersion() != GridVersion;
+	}
+	return Grid->HasPathChangedSince(Path, GridVersion);
+}
+
+bool UPathfinder::DoesCurrentPathNeedRepath() const
+{
+	return bCurrentPathNeedsRepath;
+}
+
+void UPathfinder::OnGridCreated()
+{
+	// Cells of the new Grid are unrelated to the search tree, the next incremental query starts a new one
+	IncrementalPlanner.Reset();
+}
+
+void UPathfinder::OnGridRegionChanged(FIntPoint MinIndex, FIntPoint MaxIndex)
+{
+	// The incremental planner repairs its tree around the changed cells on its next plan
+	IncrementalPlanner.NotifyRegionChanged(MinIndex, MaxIndex);
+	if (bCurrentPathNeedsRepath)
+	{
+		return;
+	}
+	// Flag the current path and notify listeners if any of its cells is in the changed region
+	for (int32 Cell : CurrentPath)
 	{
-		Node->setNodeVisibility(false);
-		Node->SetColorOnWalkable();
+		int32 IndexX = Grid->GetCellX(Cell);
+		int32 IndexY = Grid->GetCellY(Cell);
+		if (IndexX >= MinIndex.X && IndexX <= MaxIndex.X && IndexY >= MinIndex.Y && IndexY <= MaxIndex.Y)
+		{
+			bCurrentPathNeedsRepath = true;
+			OnCurrentPathInvalidated.Broadcast();
+			return;
+		}
 	}
 }
 
+void UPathfinder::HighlightCurrentPath()
+{
+	if (CurrentPath.IsEmpty())
+	{
+		return;
+	}
+	// Change the color of all path cells to black in one batch, then the first cell of the path to green and the last cell to yellow, and set them visible
+	Grid->HighlightCells(CurrentPath, FColor::Black, 1.0f);
+	if (CurrentPath.Num() > 1)
+	{
+		Grid->HighlightCell(CurrentPath.Last(), FColor::Yellow, 1.0f);
+	}
+	Grid->HighlightCell(CurrentPath[0], FColor::Green, 1.0f);
+}
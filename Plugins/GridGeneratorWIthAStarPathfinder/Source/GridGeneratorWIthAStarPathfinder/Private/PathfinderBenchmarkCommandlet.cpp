@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathfinderBenchmarkCommandlet.h"
+#include "MapGenerator.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformMemory.h"
+
+UPathfinderBenchmarkCommandlet::UPathfinderBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPathfinderBenchmarkCommandlet::Main(const FString& Params)
+{
+	// Read the configurations from the command line, every size is run with every density
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamsMap;
+	ParseCommandLine(*Params, Tokens, Switches, ParamsMap);
+	auto ParseIntList = [&ParamsMap](const TCHAR* Key, const TCHAR* Default)
+	{
+		TArray<FString> Values;
+		FString(ParamsMap.Contains(Key) ? ParamsMap[Key] : Default).ParseIntoArray(Values, TEXT(","));
+		TArray<int32> Ints;
+		for (const FString& Value : Values)
+		{
+			Ints.Add(FCString::Atoi(*Value));
+		}
+		return Ints;
+	};
+	TArray<int32> GridSizes = ParseIntList(TEXT("Sizes"), TEXT("64,128,256"));
+	TArray<int32> Densities = ParseIntList(TEXT("Densities"), TEXT("0,2,5"));
+	int32 NumQueries = ParamsMap.Contains(TEXT("Queries")) ? FCString::Atoi(*ParamsMap[TEXT("Queries")]) : 1000;
+	int32 Seed = ParamsMap.Contains(TEXT("Seed")) ? FCString::Atoi(*ParamsMap[TEXT("Seed")]) : 1;
+	FString OutputPath = ParamsMap.Contains(TEXT("Output")) ? ParamsMap[TEXT("Output")] : FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("PathfinderBenchmark.csv");
+	// Seed 0 would let SpawnObstacles pick a new seed, so the maps wouldn't be reproducible
+	if (Seed == 0)
+	{
+		Seed = 1;
+	}
+	const FBenchmarkMode Modes[] =
+	{
+		{ TEXT("AStar"), EPathSearchMode::AStar, false },
+		{ TEXT("BidirectionalAStar"), EPathSearchMode::AStar, true },
+		{ TEXT("JumpPointSearch"), EPathSearchMode::JumpPointSearch, false },
+		{ TEXT("ThetaStar"), EPathSearchMode::ThetaStar, false },
+	};
+	FString Report = TEXT("GridSize,Density,Seed,BakeMs,MapMemoryKB,Mode,Queries,PathsFound,P50Ms,P99Ms,MeanMs,P50Analyzed,P99Analyzed,MeanAnalyzed,WarmupAllocations,Allocations,QueryMemoryKB\n");
+	for (int32 GridSize : GridSizes)
+	{
+		for (int32 Density : Densities)
+		{
+			uint64 MemoryBeforeMap = FPlatformMemory::GetStats().UsedPhysical;
+			UWorld* World = nullptr;
+			AGrid* Grid = CreateBenchmarkMap(GridSize, Density, Seed, World);
+			if (Grid == nullptr)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Failed to create the benchmark map of size %i and density %i"), GridSize, Density);
+				DestroyBenchmarkMap(World);
+				return 1;
+			}
+			int64 MapMemoryKB = (int64(FPlatformMemory::GetStats().UsedPhysical) - int64(MemoryBeforeMap)) / 1024;
+			FString MapLabel = FString::Printf(TEXT("%i,%i,%i,%f,%lld"), GridSize, Density, Seed, Grid->GetLastBakeTimeMs(), MapMemoryKB);
+			// All modes search the same queries on the same map
+			TArray<TPair<int32, int32>> Queries;
+			CreateQuerySet(*Grid, NumQueries, Seed, Queries);
+			for (const FBenchmarkMode& Mode : Modes)
+			{
+				RunQuerySet(*Grid, Mode, Queries, MapLabel, Report);
+			}
+			DestroyBenchmarkMap(World);
+		}
+	}
+	if (!FFileHelper::SaveStringToFile(Report, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write the benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+	UE_LOG(LogTemp, Display, TEXT("Benchmark results written to %s"), *OutputPath);
+	return 0;
+}
+
+AGrid* UPathfinderBenchmarkCommandlet::CreateBenchmarkMap(int32 GridSize, int32 Density, int32 Seed, UWorld*& OutWorld) const
+{
+	// Create a game world with a physics scene for the grid traces, it's never rendered
+	OutWorld = UWorld::CreateWorld(EWorldType::Game, false, TEXT("PathfinderBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(OutWorld);
+	// Spawn the grid deferred, so its construction script sees the benchmark size, cells aren't visualized
+	AGrid* Grid = OutWorld->SpawnActorDeferred<AGrid>(AGrid::StaticClass(), FTransform::Identity);
+	if (Grid == nullptr)
+	{
+		return nullptr;
+	}
+	Grid->GridSizeX = GridSize;
+	Grid->GridSizeY = GridSize;
+	Grid->bSpawnNodeActors = false;
+	Grid->FinishSpawning(FTransform::Identity);
+	// Spawn a floor under the whole grid, the cells find their ground on its top at the height of the grid
+	UStaticMesh* CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	AStaticMeshActor* Floor = OutWorld->SpawnActor<AStaticMeshActor>(FVector(0.0f, 0.0f, -5.0f), FRotator::ZeroRotator);
+	if (Floor == nullptr || CubeMesh == nullptr)
+	{
+		return nullptr;
+	}
+	FVector2D GridWorldSize = Grid->GetGridWorldSize();
+	Floor->GetStaticMeshComponent()->SetStaticMesh(CubeMesh);
+	Floor->GetStaticMeshComponent()->SetWorldScale3D(FVector(GridWorldSize.X / 100.0f, GridWorldSize.Y / 100.0f, 0.1f));
+	// Spawn the obstacles with the map generator logic, a quarter of them non-blocking walls with an entrance
+	AMapGenerator* MapGenerator = OutWorld->SpawnActor<AMapGenerator>(FVector::ZeroVector, FRotator::ZeroRotator);
+	if (MapGenerator == nullptr)
+	{
+		return nullptr;
+	}
+	MapGenerator->Grid = Grid;
+	MapGenerator->nBlockingObstacles = GridSize * GridSize * Density / 1000;
+	MapGenerator->nNonblockingObstacles = MapGenerator->nBlockingObstacles / 4;
+	MapGenerator->RandomSeed = Seed;
+	MapGenerator->SpawnObstacles();
+	// Tick the world so the physics scene registers the spawned bodies before the grid traces them
+	OutWorld->Tick(LEVELTICK_All, 1.0f / 60.0f);
+	// Bake the grid, pumping the game thread until the worker threads hand the baked cells back to it
+	Grid->CreateGrid();
+	while (Grid->IsCreatingGrid())
+	{
+		FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+		FPlatformProcess::Sleep(0.001f);
+	}
+	return Grid;
+}
+
+void UPathfinderBenchmarkCommandlet::DestroyBenchmarkMap(UWorld* World) const
+{
+	if (World == nullptr)
+	{
+		return;
+	}
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+void UPathfinderBenchmarkCommandlet::CreateQuerySet(const AGrid& Grid, int32 NumQueries, int32 Seed, TArray<TPair<int32, int32>>& OutQueries)
+{
+	// Collect the walkable cells, and pick random pairs of them, the same seed always picks the same pairs on the same map
+	TArray<int32> WalkableCells;
+	for (int32 CellIndex = 0; CellIndex < Grid.GetNumCells(); CellIndex++)
+	{
+		if (Grid.IsCellWalkable(CellIndex))
+		{
+			WalkableCells.Add(CellIndex);
+		}
+	}
+	OutQueries.Reset();
+	if (WalkableCells.IsEmpty())
+	{
+		return;
+	}
+	FRandomStream RandomStream(Seed);
+	for (int32 QueryIndex = 0; QueryIndex < NumQueries; QueryIndex++)
+	{
+		int32 StartCell = WalkableCells[RandomStream.RandHelper(WalkableCells.Num())];
+		int32 TargetCell = WalkableCells[RandomStream.RandHelper(WalkableCells.Num())];
+		OutQueries.Add(TPair<int32, int32>(StartCell, TargetCell));
+	}
+}
+
+void UPathfinderBenchmarkCommandlet::RunQuerySet(AGrid& Grid, const FBenchmarkMode& Mode, const TArray<TPair<int32, int32>>& Queries, const FString& MapLabel, FString& Report) const
+{
+	if (Queries.IsEmpty())
+	{
+		return;
+	}
+	// Pathfinder searching the grid directly, without the path cache so every query is searched
+	UPathfinder* Pathfinder = NewObject<UPathfinder>(&Grid);
+	Pathfinder->Grid = &Grid;
+	Pathfinder->SearchMode = Mode.SearchMode;
+	Pathfinder->bUseBidirectionalSearch = Mode.bBidirectional;
+	Pathfinder->bUsePathCache = false;
+	FScopedPathQueryContext Context(Grid.GetQueryContextPool());
+	TArray<int32> Path;
+	// Warm up the context and the path array with the first query, the allocations of the timed queries show the steady state
+	int32 AllocationsBeforeWarmup = Context.Get().GetNumAllocations();
+	Pathfinder->SearchPath(Context.Get(), Queries[0].Key, Queries[0].Value, Path);
+	int32 WarmupAllocations = Context.Get().GetNumAllocations() - AllocationsBeforeWarmup;
+	// Search every query, timing each one alone
+	TArray<double> Latencies;
+	TArray<int32> AnalyzedCells;
+	Latencies.Reserve(Queries.Num());
+	AnalyzedCells.Reserve(Queries.Num());
+	int32 NumPathsFound = 0;
+	int32 AllocationsBefore = Context.Get().GetNumAllocations();
+	uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	for (const TPair<int32, int32>& Query : Queries)
+	{
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		bool bPathFound = Pathfinder->SearchPath(Context.Get(), Query.Key, Query.Value, Path);
+		Latencies.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+		AnalyzedCells.Add(Context.Get().GetNumAnalyzed());
+		NumPathsFound += bPathFound ? 1 : 0;
+	}
+	int32 Allocations = Context.Get().GetNumAllocations() - AllocationsBefore;
+	int64 QueryMemoryKB = (int64(FPlatformMemory::GetStats().UsedPhysical) - int64(MemoryBefore)) / 1024;
+	// Sort the samples to read their percentiles
+	double TotalLatency = 0.0;
+	int64 TotalAnalyzed = 0;
+	for (int32 Index = 0; Index < Queries.Num(); Index++)
+	{
+		TotalLatency += Latencies[Index];
+		TotalAnalyzed += AnalyzedCells[Index];
+	}
+	Latencies.Sort();
+	AnalyzedCells.Sort();
+	FString Row = FString::Printf(TEXT("%s,%s,%i,%i,%f,%f,%f,%i,%i,%f,%i,%i,%lld"), *MapLabel, Mode.Name, Queries.Num(), NumPathsFound,
+		GetPercentile(Latencies, 50), GetPercentile(Latencies, 99), TotalLatency / Queries.Num(),
+		GetPercentile(AnalyzedCells, 50), GetPercentile(AnalyzedCells, 99), double(TotalAnalyzed) / Queries.Num(),
+		WarmupAllocations, Allocations, QueryMemoryKB);
+	UE_LOG(LogTemp, Display, TEXT("%s"), *Row);
+	Report += Row + TEXT("\n");
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathfindingStats.h"
+#include "PathQueryContext.h"
+#include "HAL/IConsoleManager.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+DEFINE_STAT(STAT_PathfindingSearch);
+DEFINE_STAT(STAT_PathfindingSearchStep);
+DEFINE_STAT(STAT_PathfindingNeighborExpansion);
+DEFINE_STAT(STAT_PathfindingHeuristic);
+DEFINE_STAT(STAT_PathfindingRetrace);
+DEFINE_STAT(STAT_PathfindingSmoothPath);
+DEFINE_STAT(STAT_PathfindingGridBake);
+DEFINE_STAT(STAT_PathfindingGridPublish);
+DEFINE_STAT(STAT_PathfindingRebakeRegion);
+DEFINE_STAT(STAT_PathfindingTileBake);
+DEFINE_STAT(STAT_PathfindingFlowField);
+DEFINE_STAT(STAT_PathfindingQueries);
+DEFINE_STAT(STAT_PathfindingNodesExpanded);
+DEFINE_STAT(STAT_PathfindingWalkabilityLookups);
+DEFINE_STAT(STAT_PathfindingAllocations);
+
+// Counters of the last query, graphed over time in Insights captures
+TRACE_DECLARE_FLOAT_COUNTER(PathfindingQueryLatency, TEXT("Pathfinding/QueryLatencyMs"));
+TRACE_DECLARE_INT_COUNTER(PathfindingNodesExpanded, TEXT("Pathfinding/NodesExpanded"));
+TRACE_DECLARE_INT_COUNTER(PathfindingPeakOpenNodes, TEXT("Pathfinding/PeakOpenSet"));
+
+std::atomic<uint64> FPathfindingStats::NumQueries = 0;
+std::atomic<uint64> FPathfindingStats::NumPathsFound = 0;
+std::atomic<uint64> FPathfindingStats::NodesExpanded = 0;
+std::atomic<uint64> FPathfindingStats::WalkabilityLookups = 0;
+std::atomic<uint64> FPathfindingStats::Allocations = 0;
+std::atomic<uint32> FPathfindingStats::PeakOpenNodes = 0;
+std::atomic<uint32> FPathfindingStats::LatencyBuckets[FPathfindingStats::NumLatencyBuckets] = {};
+
+static FAutoConsoleCommand DumpPathfindingStatsCommand(
+	TEXT("Pathfinding.DumpStats"),
+	TEXT("Log the totals and the latency histogram of the path queries recorded since the last reset"),
+	FConsoleCommandDelegate::CreateStatic(&FPathfindingStats::Dump));
+
+static FAutoConsoleCommand ResetPathfindingStatsCommand(
+	TEXT("Pathfinding.ResetStats"),
+	TEXT("Clear the recorded path query counters and latency histogram"),
+	FConsoleCommandDelegate::CreateStatic(&FPathfindingStats::Reset));
+
+void FPathfindingStats::RecordQuery(const FPathQueryContext& Context, double SearchTimeMs, bool bPathFound)
+{
+	// Relaxed atomics are enough, the counters are only read as totals
+	NumQueries.fetch_add(1, std::memory_order_relaxed);
+	NumPathsFound.fetch_add(bPathFound ? 1 : 0, std::memory_order_relaxed);
+	NodesExpanded.fetch_add(Context.GetNumAnalyzed(), std::memory_order_relaxed);
+	WalkabilityLookups.fetch_add(Context.GetNumWalkabilityLookups(), std::memory_order_relaxed);
+	Allocations.fetch_add(Context.GetNumQueryAllocations(), std::memory_order_relaxed);
+	uint32 QueryPeak = Context.GetPeakOpenNodes();
+	uint32 Peak = PeakOpenNodes.load(std::memory_order_relaxed);
+	while (QueryPeak > Peak && !PeakOpenNodes.compare_exchange_weak(Peak, QueryPeak, std::memory_order_relaxed))
+	{
+	}
+	LatencyBuckets[GetLatencyBucket(SearchTimeMs)].fetch_add(1, std::memory_order_relaxed);
+	// Per frame totals shown by stat Pathfinding
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	INC_DWORD_STAT_BY(STAT_PathfindingNodesExpanded, Context.GetNumAnalyzed());
+	INC_DWORD_STAT_BY(STAT_PathfindingWalkabilityLookups, Context.GetNumWalkabilityLookups());
+	INC_DWORD_STAT_BY(STAT_PathfindingAllocations, Context.GetNumQueryAllocations());
+	TRACE_COUNTER_SET(PathfindingQueryLatency, SearchTimeMs);
+	TRACE_COUNTER_SET(PathfindingNodesExpanded, Context.GetNumAnalyzed());
+	TRACE_COUNTER_SET(PathfindingPeakOpenNodes, QueryPeak);
+}
+
+uint64 FPathfindingStats::GetNumQueries()
+{
+	return NumQueries.load(std::memory_order_relaxed);
+}
+
+double FPathfindingStats::GetLatencyPercentileMs(int32 Percentile)
+{
+	// Walk the buckets until they hold the input share of the recorded queries
+	uint64 Counts[NumLatencyBuckets];
+	uint64 Total = 0;
+	for (int32 Bucket = 0; Bucket < NumLatencyBuckets; Bucket++)
+	{
+		Counts[Bucket] = LatencyBuckets[Bucket].load(std::memory_order_relaxed);
+		Total += Counts[Bucket];
+	}
+	if (Total == 0)
+	{
+		return 0.0;
+	}
+	uint64 Rank = FMath::Max<uint64>((Total * FMath::Clamp(Percentile, 0, 100) + 99) / 100, 1);
+	uint64 Count = 0;
+	for (int32 Bucket = 0; Bucket < NumLatencyBuckets; Bucket++)
+	{
+		Count += Counts[Bucket];
+		if (Count >= Rank)
+		{
+			return double(1ull << Bucket) / 1000.0;
+		}
+	}
+	return double(1ull << (NumLatencyBuckets - 1)) / 1000.0;
+}
+
+void FPathfindingStats::Dump()
+{
+	uint64 Queries = NumQueries.load(std::memory_order_relaxed);
+	UE_LOG(LogTemp, Log, TEXT("Pathfinding queries: %llu (%llu paths found), nodes expanded: %llu, walkability lookups: %llu, allocations: %llu, peak open set: %u"),
+		Queries, NumPathsFound.load(std::memory_order_relaxed), NodesExpanded.load(std::memory_order_relaxed), WalkabilityLookups.load(std::memory_order_relaxed),
+		Allocations.load(std::memory_order_relaxed), PeakOpenNodes.load(std::memory_order_relaxed));
+	UE_LOG(LogTemp, Log, TEXT("Pathfinding query latency p50: <= %f ms, p90: <= %f ms, p99: <= %f ms"), GetLatencyPercentileMs(50), GetLatencyPercentileMs(90), GetLatencyPercentileMs(99));
+	for (int32 Bucket = 0; Bucket < NumLatencyBuckets; Bucket++)
+	{
+		uint32 Count = LatencyBuckets[Bucket].load(std::memory_order_relaxed);
+		if (Count > 0)
+		{
+			// The last bucket has no upper bound, it is labelled with its lower bound instead
+			if (Bucket == NumLatencyBuckets - 1)
+			{
+				UE_LOG(LogTemp, Log, TEXT("  >= %llu us: %u"), 1ull << (Bucket - 1), Count);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Log, TEXT("  < %llu us: %u"), 1ull << Bucket, Count);
+			}
+		}
+	}
+}
+
+void FPathfindingStats::Reset()
+{
+	NumQueries.store(0, std::memory_order_relaxed);
+	NumPathsFound.store(0, std::memory_order_relaxed);
+	NodesExpanded.store(0, std::memory_order_relaxed);
+	WalkabilityLookups.store(0, std::memory_order_relaxed);
+	Allocations.store(0, std::memory_order_relaxed);
+	PeakOpenNodes.store(0, std::memory_order_relaxed);
+	for (std::atomic<uint32>& Bucket : LatencyBuckets)
+	{
+		Bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+int32 FPathfindingStats::GetLatencyBucket(double SearchTimeMs)
+{
+	// Bucket N holds latencies below 2^N microseconds, found from the highest set bit of the whole microseconds
+	uint64 Microseconds = uint64(FMath::Max(SearchTimeMs, 0.0) * 1000.0);
+	if (Microseconds == 0)
+	{
+		return 0;
+	}
+	return FMath::Min(int32(FMath::FloorLog2_64(Microseconds)) + 1, NumLatencyBuckets - 1);
+}
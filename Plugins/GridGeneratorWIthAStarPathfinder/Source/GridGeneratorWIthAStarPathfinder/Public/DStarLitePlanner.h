@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeHeap.h"
+
+class AGrid;
+
+// Incremental planner using D* Lite, keeps its search tree between plans so replanning after the start moves or cells change walkable state only repairs the affected part
+// Searches backwards from the target, so moving the start along the path doesn't invalidate the tree, uses the same moves and costs as the pathfinder
+// Runs on the game thread, one planner per agent
+class GRIDGENERATORWITHASTARPATHFINDER_API FDStarLitePlanner
+{
+public:
+	// Start a new plan between the input cells on the input Grid, discarding the search tree of the last plan
+	void Initialize(const AGrid& InGrid, int32 InStartCell, int32 InTargetCell);
+	// Remove the search tree, the planner must be initialized again before planning
+	void Reset();
+	// Check if the planner was initialized on a grid with the input number of cells
+	bool IsInitialized(int32 NumCells) const;
+	// Get the start cell of the plan
+	int32 GetStartCell() const;
+	// Get the target cell of the plan
+	int32 GetTargetCell() const;
+	// Move the start of the plan, as the agent walks along the path, keeping the search tree
+	void SetStartCell(int32 InStartCell);
+	// Tell the planner that the walkable state of the cells between the input min and max indices (inclusive) changed, the tree is repaired by the next Plan
+	void NotifyRegionChanged(FIntPoint MinIndex, FIntPoint MaxIndex);
+	// Repair the search tree and set OutPath to the path from the start cell to the target cell, returns false if no path exists
+	bool Plan(TArray<int32>& OutPath);
+	// Get the number of cells expanded by the last Plan
+	int32 GetNumExpanded() const;
+
+private:
+	// Search state of a cell, the cell is consistent if g_cost equals rhs, rhs is the one step lookahead cost of reaching the target
+	struct FPlannerCell
+	{
+		int32 g_cost;
+		int32 rhs;
+	};
+
+	// Expand inconsistent cells until the start cell is consistent and no cell in the queue can improve it
+	void ComputeShortestPath();
+	// Recalculate the rhs of a cell from its neighbors, and add, move or remove it in the queue depending on its consistency
+	void UpdateCell(int32 CellIndex);
+	// Calculate the rhs of a cell from the g_cost of its neighbors
+	int32 CalculateRhs(int32 CellIndex);
+	// Calculate the queue key of a cell, the first part is stored as f_cost and the second as h_cost of the heap
+	void CalculateKey(int32 CellIndex, int32& OutKey1, int32& OutKey2) const;
+	// Check if key A is smaller than key B
+	static bool IsKeyLess(int32 A1, int32 A2, int32 B1, int32 B2);
+	// Get the cost of the move between 2 neighbor cells, Infinity if either is unwalkable
+	int32 GetMoveCost(int32 FromCell, int32 ToCell) const;
+	// Get the distance between 2 cells, used as heuristic from the start cell, never overestimates since every cell costs at least 1
+	// It isn't scaled by the cheapest cell cost like the pathfinder heuristic, since that can drop when cells are rebaked and keys in the queue must stay valid
+	int32 GetDistanceBetweenCells(int32 StartCell, int32 EndCell) const;
+	// Add 2 costs, keeping Infinity if either is Infinity
+	static int32 AddCosts(int32 A, int32 B);
+
+	// Cost of unreachable cells, small enough that keys including it don't overflow
+	static constexpr int32 Infinity = MAX_int32 / 4;
+
+	const AGrid* Grid = nullptr;							// Grid the plan runs on
+	TArray<FPlannerCell> Cells;								// Search state of every cell of the grid, indexed by cell index
+	FNodeHeap Queue;										// Inconsistent cells ordered by their keys
+	int32 StartCell = INDEX_NONE;							// Start cell of the plan
+	int32 TargetCell = INDEX_NONE;							// Target cell of the plan, the root of the search tree
+	int32 LastStartCell = INDEX_NONE;						// Start cell when the keys were last adjusted
+	int32 KeyModifier = 0;									// Sum of the heuristic changes caused by moving the start, added to new keys so old keys in the queue stay valid lower bounds
+	int32 NumExpanded = 0;									// Number of cells expanded by the last Plan
+};
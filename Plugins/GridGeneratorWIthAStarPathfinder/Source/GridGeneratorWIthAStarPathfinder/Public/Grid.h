@@ -5,9 +5,46 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "GridNode.h"
+#include "PathQueryContext.h"
+#include "GridClusterGraph.h"
+#include "PathCache.h"
+#include "GridFlowField.h"
 #include "ProceduralMeshComponent.h"
+#include "Tasks/Task.h"
+#include <atomic>
 #include "Grid.generated.h"
 
+// Delegate broadcast on the game thread when the cells baked by CreateGrid are published
+DECLARE_MULTICAST_DELEGATE(FOnGridCreated);
+// Delegate broadcast on the game thread when RebakeRegion changed the walkable state or cost of cells, with the min and max indices (inclusive) of the changed cells
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnGridRegionChanged, FIntPoint, FIntPoint);
+
+// Cardinal directions on the Grid, East is +X and North is +Y, used to index the jump distance tables
+enum class EGridDirection : uint8
+{
+	East,
+	West,
+	North,
+	South,
+	Num
+};
+
+class UPhysicalMaterial;
+class UHierarchicalInstancedStaticMeshComponent;
+
+// Volume setting the cost of the cells whose center is inside its bounds, used to mark roads, mud or danger zones
+USTRUCT()
+struct FGridCostVolume
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Cell Costs")
+		AActor* Volume = nullptr;							// Actor whose bounds cover the cells
+
+	UPROPERTY(EditAnywhere, Category = "Cell Costs", meta = (ClampMin = "1"))
+		uint8 Cost = 1;										// Cost multiplier of the covered cells
+};
+
 UCLASS()
 class GRIDGENERATORWITHASTARPATHFINDER_API AGrid : public AActor
 {
@@ -20,25 +57,315 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	// Called when the game ends or the grid is destroyed, waits for a running bake so it doesn't trace a destroyed world
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	// Function called after construction and before begin play to use variable set in the editor to change different aspects of this class behavior
 #if WITH_EDITOR
 	virtual void OnConstruction(const FTransform& Transform) override;
 #endif
 
 public:
-	// Spawn GridNodes in the Grid formation and make them check for obstacles and set them as walkable or not
+	// Bake the walkable state and height of every cell of the Grid in tiles on worker threads, then publish them to the cell buffers on the game thread and spawn GridNodes to visualize them if bSpawnNodeActors is set
+	// Returns immediately, the cell buffers keep the last grid until OnGridCreated is broadcast, calling it again during a bake discards the running one
+	// If bUseBakedGridFile is set and the baked grid file matches the level, the cells are loaded from it and published before returning instead
+	// If bUseTileStreaming is set, all cells are published as unknown cells before returning, and tiles are baked when requested or near a streaming source
 	void CreateGrid();
-	// Get pointer to GridNode on the Grid from input location
+	// Bake the grid by tracing every cell, and save the cells to the baked grid file once published, used in the editor so levels load the cells instead of tracing them
+	UFUNCTION(CallInEditor, Category = "Baked Grid")
+		void BakeGridToFile();
+	// Map the baked grid file and publish its cells if its header matches the grid layout and the level hash, returns false if the file is missing or stale
+	bool LoadBakedGrid();
+	// Get the path of the baked grid file of this grid
+	FString GetBakedGridPath() const;
+	// Check if a bake started by CreateGrid wasn't published yet
+	bool IsCreatingGrid() const;
+	// Get the time in milliseconds between the last published CreateGrid call and its publish
+	double GetLastBakeTimeMs() const;
+	// Get pointer to GridNode on the Grid from input location, returns nullptr if node actors weren't spawned
 	AGridNode* NodeFromLocation(FVector WorldLocation);
-	// Get all neighbor nodes if exist to the input node, used in pathfinding
+	// Get all neighbor nodes if exist to the input node, returns empty array if node actors weren't spawned
 	TArray<AGridNode*> GetNeighborNodes(AGridNode* Node);
 	// Get Grid Size in actual world units
 	FVector2D GetGridWorldSize();
+	// Check if the input node is walkable using the baked walkability bitmap, doesn't run any traces
+	bool IsNodeWalkable(const AGridNode* Node) const;
+	// Check if the node with the input X and Y indices is walkable using the baked walkability bitmap
+	bool IsWalkable(int32 IndexX, int32 IndexY) const;
+	// Rerun the walkability traces for the nodes between the input min and max indices (inclusive), and update the walkability bitmap and cell costs with the results
+	// If any cell changed walkable state or cost, the grid version is incremented and OnGridRegionChanged is broadcast
+	void RebakeRegion(FIntPoint MinIndex, FIntPoint MaxIndex);
+	// Rebake the cells covered by the input world space box, used when an obstacle spawned, moved or was destroyed
+	void MarkRegionDirty(const FBox& WorldBounds);
+	// Rebake the cells covered by the bounds of the input actor
+	void MarkActorDirty(AActor* Actor);
+	// Keep the cells under the input actor up to date, rebaking the cells it leaves and enters whenever its root component moves
+	void RegisterDynamicObstacle(AActor* Actor);
+	// Stop rebaking cells when the input actor moves
+	void UnregisterDynamicObstacle(AActor* Actor);
+	// Get the version of the walkable state of the cells, incremented whenever cells change walkable state or the grid is recreated
+	uint32 GetGridVersion() const;
+	// Check if any cell of the input path changed walkable state since the input version of the grid
+	bool HasPathChangedSince(const TArray<int32>& Path, uint32 Version) const;
+
+	// Get the index of the cell containing the input location, returns INDEX_NONE if the location is outside the grid
+	int32 CellFromLocation(FVector WorldLocation) const;
+	// Set OutCells[i] to the index of the cell containing Locations[i] in one pass, used to find the cells of many agents every tick
+	// Each cell contains the square footprint around the center CreateGrid traced it at, locations on the far edges of the grid belong to the last row or column
+	// Returns the number of locations outside the grid, their cells are set to INDEX_NONE
+	int32 CellsFromLocations(TArrayView<const FVector> Locations, TArrayView<int32> OutCells) const;
+	// Fill the input array with the indices of all cells neighboring the input cell
+	void GetNeighborCells(int32 CellIndex, TArray<int32>& OutNeighborCells) const;
+	// Call Func with the index of each cell neighboring the input cell, in the same order as GetNeighborCells, without allocating, used in pathfinding
+	template <typename FuncType>
+	void ForEachNeighborCell(int32 CellIndex, FuncType&& Func) const
+	{
+		uint8 Mask = GetNeighborMask(CellIndex);
+		for (int32 Direction = 0; Direction < 8; Direction++)
+		{
+			if (Mask & (1 << Direction))
+			{
+				Func(CellIndex + NeighborOffsets[Direction]);
+			}
+		}
+	}
+	// Get the bit mask of the neighbor directions of the input cell that are inside the grid, bit N set if the neighbor in direction N exists
+	uint8 GetNeighborMask(int32 CellIndex) const;
+	// Get the cell index offset of the neighbor in the input direction, directions are ordered like NeighborDirectionsX and NeighborDirectionsY
+	int32 GetNeighborOffset(int32 Direction) const { return NeighborOffsets[Direction]; }
+
+	// Call Func with the index of each cell on the straight line between the centers of the input cells, from the cell after FromCell up to ToCell
+	// The line steps diagonally where it crosses a cell corner exactly, so consecutive cells are neighbors and the walk can be used as a path, the same cells are walked in both directions
+	// Func returns false to stop the walk, returns false if the walk was stopped
+	template <typename FuncType>
+	bool ForEachCellOnLine(int32 FromCell, int32 ToCell, FuncType&& Func) const
+	{
+		int32 DistanceX = FMath::Abs(GetCellX(ToCell) - GetCellX(FromCell));
+		int32 DistanceY = FMath::Abs(GetCellY(ToCell) - GetCellY(FromCell));
+		int32 OffsetX = GetCellX(ToCell) > GetCellX(FromCell) ? 1 : -1;
+		int32 OffsetY = GetCellY(ToCell) > GetCellY(FromCell) ? GridSizeX : -GridSizeX;
+		int32 Cell = FromCell;
+		// Step towards whichever cell border the line crosses next, comparing the crossing distances in integers scaled by 2 * DistanceX * DistanceY
+		for (int32 StepsX = 0, StepsY = 0; StepsX < DistanceX || StepsY < DistanceY; )
+		{
+			int64 Decision = int64(2 * StepsX + 1) * DistanceY - int64(2 * StepsY + 1) * DistanceX;
+			if (Decision <= 0)
+			{
+				Cell += OffsetX;
+				StepsX++;
+			}
+			if (Decision >= 0)
+			{
+				Cell += OffsetY;
+				StepsY++;
+			}
+			if (!Func(Cell))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	// Check if the straight line between the centers of the input cells only crosses walkable cells whose cost is at most MaxCellCost, using the baked walkability bitmap without any traces
+	// Where the line passes a cell corner diagonally, both cells beside the corner must be open too, so lines don't squeeze between blocked cells
+	bool HasLineOfSight(int32 FromCell, int32 ToCell, uint8 MaxCellCost = MAX_uint8) const;
+	// X and Y steps of the 8 neighbor directions, ordered by Y then X from (-1, -1) to (1, 1) skipping the cell itself
+	static constexpr int32 NeighborDirectionsX[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+	static constexpr int32 NeighborDirectionsY[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+	// Get the world location of the center of the input cell
+	FVector GetCellLocation(int32 CellIndex) const;
+	// Get the index of the cell with the input X and Y indices
+	int32 GetCellIndex(int32 IndexX, int32 IndexY) const;
+	// Get the X index of the input cell
+	int32 GetCellX(int32 CellIndex) const;
+	// Get the Y index of the input cell
+	int32 GetCellY(int32 CellIndex) const;
+	// Get the number of cells baked by CreateGrid
+	int32 GetNumCells() const;
+	// Check if the input cell is walkable using the baked walkability bitmap
+	bool IsCellWalkable(int32 CellIndex) const;
+	// Get the height of the ground under the input cell found when baking it
+	float GetCellHeight(int32 CellIndex) const;
+	// Get the cost multiplier of the input cell, baked from the physical material of its ground and the cost volumes covering it, at least 1
+	uint8 GetCellCost(int32 CellIndex) const;
+	// Get the cost of the move between 2 neighbor cells, the input base cost of the move (10 straight, 14 diagonal) scaled by the average cost of both cells, so it's the same in both directions
+	int32 GetMoveCost(int32 FromCell, int32 ToCell, int32 BaseCost) const;
+	// Get the smallest cost multiplier of all cells, searches scale their distance heuristic by it so it never overestimates
+	int32 GetMinCellCost() const;
+	// Check if all cells have the same cost, required by jump point search
+	bool HasUniformCellCosts() const;
+	// Get the GridNode visualizing the input cell, returns nullptr if node actors weren't spawned
+	AGridNode* GetCellNode(int32 CellIndex) const;
+	// Show the input cell with the input color and opacity, does nothing if the cells aren't visualized
+	// With the instanced cell view only the instance data is written, the render state is updated once for all cells changed in the frame
+	void HighlightCell(int32 CellIndex, FColor Color, float Opacity);
+	// Show all input cells with the input color and opacity, used to highlight whole paths or search sets at once
+	void HighlightCells(TArrayView<const int32> Cells, FColor Color, float Opacity);
+	// Restore the input cell to its default color and visibility based on its walkable state
+	void ResetCellHighlight(int32 CellIndex);
+	// Check if a move in the input direction arriving at the cell with the input X and Y indices has a forced neighbor, a cell only reachable optimally through it because of an adjacent obstacle
+	// Direction can be straight or diagonal, used by jump point search
+	bool HasForcedNeighbor(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY) const;
+	// Get the baked jump distance of the input cell in the input direction
+	// A positive distance is the number of steps to the next cell with a forced neighbor, else its negation is the number of walkable steps before an unwalkable cell or the grid edge
+	int32 GetJumpDistance(int32 CellIndex, EGridDirection Direction) const;
+	// Get the cluster graph used for hierarchical pathfinding, only built if bBuildClusterGraph is set
+	const FGridClusterGraph& GetClusterGraph() const;
+	// Get the pool of search contexts used by pathfinders querying this Grid, the Grid itself isn't modified by searches
+	FPathQueryContextPool& GetQueryContextPool();
+	// Get the cache of path results shared by pathfinders querying this Grid, results are only reused on the Grid version they were found on
+	FPathCache& GetPathCache();
+	// Get the flow field towards the input goal cell, building it on first use, fields of the last MaxFlowFields goals are cached and repaired when cells change
+	// Game thread only, returns nullptr if the goal is outside the grid
+	TSharedPtr<const FGridFlowField> GetFlowField(int32 GoalCell);
+	// Get the world direction an agent at the input location should move in to reach the input goal cell, zero at the goal, outside the grid or if the goal can't be reached
+	FVector GetFlowDirection(int32 GoalCell, FVector WorldLocation);
+	// Get the lock guarding the cell buffers, searches hold it for reading while CreateGrid and RebakeRegion hold it for writing
+	FRWLock& GetCellDataLock() const;
+	// Check if jump point search can run on the cells, it needs uniform cell costs and the jump distance tables, which aren't baked for grids streaming tiles
+	bool CanUseJumpPointSearch() const;
+
+	// Keep the tiles within StreamingRadiusTiles tiles of the input actor resident, only used if bUseTileStreaming is set
+	void AddStreamingSource(AActor* Actor);
+	// Stop keeping tiles resident around the input actor, its tiles are unloaded once the residency budget needs them
+	void RemoveStreamingSource(AActor* Actor);
+	// Bake the cells of the input tile on a worker task if it isn't resident or being baked, and mark it as recently used, game thread only
+	// Once baked, the changed cells are published like a rebaked region, so paths that crossed them as unknown cells are flagged for repath
+	void RequestTile(int32 TileIndex);
+	// Request the tiles of the input cells that aren't resident, used by pathfinders whose path crossed unknown cells
+	void RequestTilesForCells(TArrayView<const int32> Cells);
+	// Get the index of the streaming tile containing the input cell, INDEX_NONE if the grid doesn't stream tiles
+	int32 GetTileIndex(int32 CellIndex) const;
+	// Check if the cells of the input tile are baked, cells of tiles that aren't resident are unknown cells with UnknownCellCost
+	bool IsTileResident(int32 TileIndex) const;
+	// Check if the input cell is baked, always true if the grid doesn't stream tiles
+	bool IsCellResident(int32 CellIndex) const;
+	// Get the number of tiles whose cells are baked
+	int32 GetNumResidentTiles() const;
 
 	//Create 2D Grid Mesh 
 	void CreateGridMesh();
 	void CreateLine(FVector StartLocation, FVector EndLocation, float LineThickness, TArray<FVector>& Vertices, TArray<int32>& Triangles);
 
+	FOnGridCreated OnGridCreated;							// Broadcast on the game thread when CreateGrid published the baked cells
+	FOnGridRegionChanged OnGridRegionChanged;				// Broadcast on the game thread when RebakeRegion changed the walkable state of cells
+
+private:
+	// Cell buffers baked by the worker threads of CreateGrid, waiting to be published on the game thread
+	struct FGridBakeResult
+	{
+		uint32 BakeId = 0;									// Id of the CreateGrid call that started the bake
+		int32 NumCells = 0;
+		TBitArray<> WalkableBits;
+		TArray<float> CellHeights;
+		TArray<uint8> CellCosts;
+		int32 NumTiles = 0;									// Number of tiles the cells were baked in
+		double TraceTimeMs = 0.0;							// Time spent tracing all tiles on the worker threads
+		bool bStreamed = false;								// Set if the cells are unknown cells whose tiles are baked on request, CellHeights is then empty
+		FVector2D CellOrigin = FVector2D::ZeroVector;		// Bottom left corner of the grid when the bake started, the cells were traced from it
+		double CellSize = 0.0;								// Size of the cells when the bake started
+	};
+
+	// Residency state of a streaming tile
+	enum class ETileState : uint8
+	{
+		Unloaded,											// Cells of the tile are unknown cells
+		Loading,											// Cells of the tile are being baked on a worker task
+		Resident											// Cells of the tile are baked
+	};
+
+	// Streaming tile of StreamingTileSize cells on each side, only its cell heights are paged, the walkable state and cost of its cells are kept in the grid-wide cell buffers
+	struct FGridStreamingTile
+	{
+		ETileState State = ETileState::Unloaded;
+		TArray<float> CellHeights;							// Height of the ground under each cell of the tile, ordered by Y then X inside the tile, empty unless resident
+	};
+
+	// Cells of a streaming tile baked by a worker thread, waiting to be published on the game thread
+	struct FGridTileBakeResult
+	{
+		uint32 BakeId = 0;									// Id of the published bake the tile was requested on, tiles of an older grid are discarded
+		int32 TileIndex = INDEX_NONE;
+		TArray<uint8> Walkable;
+		TArray<float> CellHeights;
+		TArray<uint8> CellCosts;
+	};
+
+	// Cost rules of the cells captured on the game thread, so worker threads don't read the editable properties or the volume actors
+	struct FCellCostRules
+	{
+		uint8 DefaultCost = 1;
+		TMap<const UPhysicalMaterial*, uint8> MaterialCosts;
+		TArray<TPair<FBox, uint8>> VolumeCosts;				// World bounds and cost of each cost volume
+	};
+
+	// Trace settings of the cells captured on the game thread, so worker threads tracing cells never read the grid or its editable properties
+	struct FCellTraceSettings
+	{
+		TWeakObjectPtr<UWorld> World;						// World traced, checked by the worker before tracing since the level can be torn down during a bake
+		uint32 IgnoredActorId = 0;							// Unique id of the grid actor, ignored by the obstacle overlap
+		float GroundDetection = 0.0f;
+		float NodeRadius = 0.0f;
+		float MaxAllowedHeight = 0.0f;
+		FCellCostRules CostRules;
+	};
+
+	// Walkable state or cost change of the cells between 2 indices (inclusive), recorded with the grid version it created
+	struct FGridRegionChange
+	{
+		uint32 Version;
+		FIntPoint MinIndex;
+		FIntPoint MaxIndex;
+	};
+
+	// Get the min and max indices (inclusive) of the cells whose footprint overlaps the input world space box, returns false if it doesn't overlap the grid
+	bool GetCellRangeFromBox(const FBox& WorldBounds, FIntPoint& OutMin, FIntPoint& OutMax) const;
+	// Called when the root component of a registered dynamic obstacle moved, rebakes the cells under its last and new bounds
+	void OnDynamicObstacleMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+	// Swap the baked cell buffers in, rebake the data derived from them, and spawn GridNodes, runs on the game thread
+	void PublishGrid(FGridBakeResult& Result);
+	// Set the walkable state and cost of the input cell and update the visuals of the cell, returns true if either changed, the cell data lock must be held for writing
+	bool SetCellState(int32 CellIndex, bool bWalkable, uint8 Cost);
+	// Set the ground height of the input cell, in the cell buffers or in its streaming tile
+	void SetCellHeight(int32 CellIndex, float Height);
+	// Rebake the data derived from the walkable state and costs of the changed cells between the input min and max indices (inclusive), and record the change with a new grid version
+	// The cell data lock must be held for writing, OnGridRegionChanged is broadcast by the caller after releasing it
+	void CommitRegionChange(FIntPoint ChangedMin, FIntPoint ChangedMax);
+	// Get the min and max indices (inclusive) of the cells of the input streaming tile
+	void GetTileBounds(int32 TileIndex, FIntPoint& OutMin, FIntPoint& OutMax) const;
+	// Store the cells of a baked streaming tile and make it resident, then unload the least recently used tiles above MaxResidentTiles, runs on the game thread
+	void PublishTile(FGridTileBakeResult& Result);
+	// Turn the cells of the input resident tile back into unknown cells and free its heights
+	void UnloadTile(int32 TileIndex);
+	// Request the tiles around every streaming source, called every StreamingUpdateInterval seconds while the grid streams tiles
+	void UpdateStreaming();
+	// Write the published cell buffers to the baked grid file, with the current level hash, returns true if the file was written
+	bool SaveBakedGrid() const;
+	// Hash the grid layout, the trace settings, the cost rules, and the collision of the static actors over the grid, a baked grid file is only loaded if the hash it was saved with matches
+	uint64 CalculateLevelHash() const;
+	// Get the bottom left corner location of the grid, used to calculate the locations of all cells
+	FVector GetBottomLeftLocation() const;
+	// Capture the cost rules of the cells from the cost properties and the current bounds of the cost volumes
+	FCellCostRules CaptureCellCostRules() const;
+	// Capture the world, trace properties and cost rules used to trace the cells, game thread only
+	FCellTraceSettings CaptureCellTraceSettings() const;
+	// Check for ground under the input cell location and for obstacles above it in the input world, returns true if the cell is walkable
+	// Stores the ground height in OutHeight, and the cost of the cell from the input rules in OutCost, only reads the input settings so it's safe to call from worker threads
+	static bool TraceCellWalkable(UWorld& World, const FVector& CellLocation, const FCellTraceSettings& Settings, float& OutHeight, uint8& OutCost);
+	// Set the cost of the input cell, keeping the count of cells of each cost up to date
+	void SetCellCost(int32 CellIndex, uint8 Cost);
+	// Create an instance of the cell view for every cell, colored by its walkable state, or remove all instances if bUseInstancedCellView isn't set
+	void BuildCellView();
+	// Check if the cells are visualized by the instanced cell view
+	bool HasCellView() const;
+	// Write the color and opacity of the input cell to its instance data, and schedule the render state update of the cell view for the next tick
+	void SetCellViewColor(int32 CellIndex, FColor Color, float Opacity);
+	// Send the instance data written since the last update to the renderer in one render state update
+	void FlushCellView();
+	// Calculate the cell index offsets of the 8 neighbor directions for the current GridSizeX
+	void UpdateNeighborOffsets();
+	// Recalculate the jump distances in the input direction of all cells on the row (East, West) or column (North, South) with the input index
+	void BakeJumpDistances(int32 LineIndex, EGridDirection Direction);
+
 // Public variables can all be set from editor used to determine the Grid Size, nodes size, Grid mesh color, opacity and lines thickness, and whether nodes are visible or not
 public:	
 	UPROPERTY(EditAnywhere, Category = "Grid Components")
@@ -53,6 +380,69 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Grid Components")
 		float MaxAllowedHeight = 25.0f;						// Max allowable hight for objects to not be considered as obstacles		
 
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		float GroundDetection = 50.0f;						// Distance under each cell to check for ground, if no ground is found within this distance the cell is unwalkable
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		int32 BakeTileSize = 32;							// Number of cells on each side of the tiles baked in parallel by CreateGrid
+
+	UPROPERTY(EditAnywhere, Category = "Cell Costs", meta = (ClampMin = "1"))
+		uint8 DefaultCellCost = 1;							// Cost multiplier of cells without a material or volume cost, raise it so cheaper terrain like roads can be preferred
+
+	UPROPERTY(EditAnywhere, Category = "Cell Costs")
+		TMap<UPhysicalMaterial*, uint8> PhysicalMaterialCosts;	// Cost multiplier of cells whose ground has the physical material, overrides the default cost
+
+	UPROPERTY(EditAnywhere, Category = "Cell Costs")
+		TArray<FGridCostVolume> CostVolumes;				// Volumes setting the cost of the cells they cover, override material costs, the highest cost is used where volumes overlap
+
+	UPROPERTY(EditAnywhere, Category = "Baked Grid")
+		bool bUseBakedGridFile = false;						// bool determines if CreateGrid loads the cells from the baked grid file when it matches the level, instead of tracing them
+
+	UPROPERTY(EditAnywhere, Category = "Baked Grid")
+		FString BakedGridFile;								// Path of the baked grid file relative to the project content directory, empty uses BakedGrids/<Level>_<Grid>.gridbake
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming")
+		bool bUseTileStreaming = false;						// bool determines if CreateGrid only bakes the tiles near streaming sources or requested by searches, for open worlds too large to trace at once, only the cell heights are paged, the walkable bits, costs, search contexts, cluster graph and flow fields still take memory for every cell
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming", meta = (ClampMin = "1"))
+		int32 StreamingTileSize = 64;						// Number of cells on each side of a streaming tile
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming", meta = (ClampMin = "1"))
+		int32 MaxResidentTiles = 64;						// Max number of baked tiles, the least recently used tile is unloaded above it, keep it above the tiles needed by all streaming sources, bounds the memory of the cell heights only
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming", meta = (ClampMin = "0"))
+		int32 StreamingRadiusTiles = 2;						// Number of tiles around the tile of each streaming source kept resident
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming", meta = (ClampMin = "0.01"))
+		float StreamingUpdateInterval = 0.5f;				// Time in seconds between checks of the tiles around the streaming sources
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming", meta = (ClampMin = "1"))
+		uint8 UnknownCellCost = 4;							// Cost multiplier of the cells of tiles that aren't resident, so searches prefer known cells without ruling out unknown ones
+
+	UPROPERTY(EditAnywhere, Category = "Tile Streaming")
+		bool bUnknownCellsWalkable = true;					// bool determines if searches can cross the cells of tiles that aren't resident
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		bool bSpawnNodeActors = true;						// bool determines if a GridNode actor is spawned for each cell to visualize it, disable for large grids, ignored if bUseInstancedCellView is set
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		bool bUseInstancedCellView = false;					// bool determines if cells are visualized by one instanced mesh instead of GridNode actors, highlights then cost one render update per frame instead of one per cell
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		UMaterialInterface* CellViewMaterial;				// Material of the instanced cell view, reads the color from PerInstanceCustomData 0 to 2 and the opacity from PerInstanceCustomData 3
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		bool bBuildClusterGraph = false;					// bool determines if the cluster graph used for hierarchical pathfinding is built with the cells, useful for long queries on large grids
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components")
+		int32 ClusterSize = 32;								// Number of cells on each side of a cluster of the cluster graph
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components", meta = (ClampMin = "0"))
+		int32 PathCacheMaxMemoryKB = 1024;					// Max memory in kilobytes used by the path results cached for pathfinders with bUsePathCache set
+
+	UPROPERTY(EditAnywhere, Category = "Grid Components", meta = (ClampMin = "1"))
+		int32 MaxFlowFields = 8;							// Max number of flow fields cached by GetFlowField, the least recently used field is removed above it
+
 	UPROPERTY(EditAnywhere, Category = "Grid Components")
 		bool bGridVisible = false;							// bool determines if the nodes on the grid are visible or not
 
@@ -67,8 +457,45 @@ public:
 
 private:
 	USceneComponent* DefaultSceneComponent;					// Scene component used as root component for the class
-	TArray<AGridNode*> NodesArray;							// TArray of GridNodes to held pointers to all created Nodes 
+	TArray<AGridNode*> NodesArray;							// TArray of GridNodes to held pointers to all created Nodes, indexed like the cell buffers, empty if bSpawnNodeActors isn't set
+	TBitArray<> WalkableBits;								// Bit-packed walkable state of all cells, baked in CreateGrid and updated by RebakeRegion, kept for all cells even if the grid streams tiles
+	TArray<float> CellHeights;								// Height of the ground under each cell, baked with the walkable state, empty if the grid streams tiles
+	TArray<uint8> CellCosts;								// Cost multiplier of each cell, one byte per cell so the cost layer of large grids stays small
+	int32 CellCostCounts[256] = {};							// Number of cells of each cost, used to find the min cost and check if costs are uniform without scanning the cells
+	TArray<int32> JumpDistances;							// Jump distance of each cell in the 4 cardinal directions, indexed by CellIndex * 4 + direction, rebaked with the walkable state
+	int32 NumCells = 0;										// Number of cells in the cell buffers, cell index of the cell at (X, Y) is Y * GridSizeX + X
+	int32 NeighborOffsets[8] = {};							// Cell index offset of each neighbor direction, ordered like NeighborDirectionsX and NeighborDirectionsY
+	std::atomic<uint32> GridVersion = 0;					// Version of the walkable state, read by worker threads to tag the paths they find
+	uint32 OldestTrackedVersion = 0;						// Changes made before this version are no longer recorded in RegionChanges
+	TArray<FGridRegionChange> RegionChanges;				// Last walkable state changes, oldest first, at most MaxRegionChanges
+	static constexpr int32 MaxRegionChanges = 256;
+	TMap<TWeakObjectPtr<AActor>, FBox> DynamicObstacles;	// Actors rebaked when they move, with the bounds the cells were last rebaked for
+	FGridClusterGraph ClusterGraph;							// Cluster abstraction of the cells for hierarchical pathfinding, rebuilt with the walkable state
+	FPathQueryContextPool QueryContextPool;					// Pool of search contexts sized to this Grid, shared by all pathfinders using it
+	FPathCache PathCache;									// Least recently used path results of the current grid version, shared by all pathfinders using it
+	TMap<int32, TSharedPtr<FGridFlowField>> FlowFields;	// Flow fields built by GetFlowField keyed by their goal cell, repaired by RebakeRegion
+	TArray<int32> FlowFieldGoals;							// Goal cells of the cached flow fields, least recently used first
+	UE::Tasks::FTask BakeTask;								// Worker task running the last bake started by CreateGrid
+	uint32 LatestBakeId = 0;								// Id of the last CreateGrid call, results of older bakes are discarded
+	uint32 PublishedBakeId = 0;								// Id of the last bake published to the cell buffers
+	double BakeStartTime = 0.0;								// Time in seconds the last CreateGrid call started
+	double LastBakeTimeMs = 0.0;							// Time between the last published CreateGrid call and its publish in milliseconds
+	bool bSaveBakedGridOnPublish = false;					// Set by BakeGridToFile, the next published bake is saved to the baked grid file
+	bool bTileStreamingActive = false;						// Set if the published grid streams tiles, its cell heights are kept in the streaming tiles
+	int32 TileCellSize = 0;									// Number of cells on each side of the streaming tiles of the published grid
+	int32 NumTilesX = 0;									// Number of streaming tiles in the X direction of the published grid
+	TArray<FGridStreamingTile> StreamingTiles;				// Streaming tiles of the published grid, indexed by TileY * NumTilesX + TileX
+	TArray<int32> ResidentTiles;							// Indices of the resident tiles, least recently used first
+	TArray<TWeakObjectPtr<AActor>> StreamingSources;		// Actors whose surrounding tiles are kept resident
+	TArray<UE::Tasks::FTask> TileBakeTasks;					// Worker tasks baking requested tiles
+	FTimerHandle StreamingTimerHandle;						// Timer calling UpdateStreaming while the grid streams tiles
+	mutable FRWLock CellDataLock;							// Lock guarding the cell buffers against being written while asynchronous searches read them
 	FVector2D GridWorldSize;								// FVector2D to hold the size of the Created Grid in world units
+	FVector2D CellLookupOrigin = FVector2D::ZeroVector;		// Bottom left corner of the published cells, used to find the cell of a location without recomputing the grid corners
+	double CellLookupSize = 1.0;							// Size of the published cells
+	double CellLookupInverseSize = 1.0;						// Inverse of CellLookupSize, so finding the cell of a location multiplies instead of divides
+	UHierarchicalInstancedStaticMeshComponent* CellInstances;	// Instanced mesh visualizing the cells if bUseInstancedCellView is set, instance index is the cell index
+	bool bCellViewFlushPending = false;						// Set when instance data of the cell view changed and its render state update is scheduled
 	UProceduralMeshComponent* GridMesh;						// ProceduralMeshComponent used to create the 2D Grid Mesh representing the location of each node
 	UMaterialInstanceDynamic* GridMaterial;					// Dynamic Material instance for the grid mesh 
 };
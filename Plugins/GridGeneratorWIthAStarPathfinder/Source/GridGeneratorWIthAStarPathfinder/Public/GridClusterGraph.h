@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeHeap.h"
+#include "PathQueryContext.h"
+#include <atomic>
+
+class AGrid;
+
+// Cluster abstraction of the Grid used for hierarchical pathfinding (HPA*)
+// The grid is split into square clusters, the cells on both sides of each walkable opening between 2 clusters are entrances, and the cost between every pair of entrances of a cluster is precomputed
+// Long queries search the small graph of entrances first, then refine each step of the abstract path with a search bounded to a single cluster
+class GRIDGENERATORWITHASTARPATHFINDER_API FGridClusterGraph
+{
+public:
+	// Split the baked cells of the input Grid into clusters of ClusterSize * ClusterSize cells, and find the entrances and intra-cluster costs of all clusters
+	void Build(const AGrid& Grid, int32 InClusterSize);
+	// Rebuild the clusters whose entrances or costs can be changed by the cells between the input min and max indices (inclusive)
+	void RebuildRegion(const AGrid& Grid, FIntPoint MinIndex, FIntPoint MaxIndex);
+	// Remove all clusters, the graph isn't used until built again
+	void Reset();
+	// Check if the graph was built
+	bool IsBuilt() const;
+	// Get the size of the clusters in cells
+	int32 GetClusterSize() const;
+	// Find a path between the input cells by searching the entrances graph using the input context, then refining it inside each cluster, returns false if the entrances graph has no route
+	// All scratch memory is taken from the arena of the context, so steady state queries don't allocate
+	// Paths are optimal inside each cluster but only cross between clusters at entrances, so they can be slightly longer than the shortest path
+	bool FindPath(const AGrid& Grid, FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled = nullptr) const;
+
+private:
+	// Entrances and intra-cluster costs of a single cluster
+	struct FCluster
+	{
+		TArray<int32> EntranceCells;						// Cell of each entrance, a cell on a cluster corner can be an entrance on 2 borders
+		TArray<int32> PartnerCells;							// Cell on the other side of the border connected to each entrance
+		TArray<int32> Costs;								// Cost of the shortest path inside the cluster between each pair of entrances, indexed by From * NumEntrances + To, MAX_int32 if unreachable
+	};
+	// Scratch state of a search bounded to a single cluster, indexed by the cell position inside the cluster, taken from an arena so queries reuse its memory
+	struct FClusterSearch
+	{
+		explicit FClusterSearch(FPathQueryArena& Arena)
+			: OpenNodes(Arena.AllocateHeap())
+			, Costs(Arena.AllocateArray())
+			, Parents(Arena.AllocateArray())
+		{
+		}
+
+		FNodeHeap& OpenNodes;
+		TArray<int32>& Costs;
+		TArray<int32>& Parents;
+	};
+
+	// Find the entrances of the cluster on its 4 borders and the costs between them
+	void BuildCluster(const AGrid& Grid, int32 ClusterIndex);
+	// Add the entrances of the input cluster on its border in the input direction
+	void AddBorderEntrances(const AGrid& Grid, FCluster& Cluster, int32 ClusterIndex, int32 DirX, int32 DirY) const;
+	// Search from SourceCell inside the bounds of the cluster, filling the costs and parents of the scratch state
+	// Stops at TargetCell and returns its cost, or MAX_int32 if not reached, if TargetCell is INDEX_NONE all reachable cells of the cluster are searched
+	int32 SearchCluster(const AGrid& Grid, FClusterSearch& Search, int32 ClusterIndex, int32 SourceCell, int32 TargetCell) const;
+	// Append the cells of the path found by the last SearchCluster from its source cell to the input cell, not including the source cell
+	void AppendClusterPath(const FClusterSearch& Search, int32 ClusterIndex, int32 SourceCell, int32 Cell, TArray<int32>& OutPath) const;
+	// Set the input cell as reached from FromCell with the input edge cost in the abstract search, if it's not in the open set or the new g_cost is smaller
+	// The distance heuristic is multiplied by HeuristicScale, the cheapest cell cost of the grid
+	void VisitNode(FPathQueryContext& Context, int32 FromCell, int32 Cell, int32 EdgeCost, int32 HeuristicScale) const;
+	// Get the index of the cluster containing the input cell
+	int32 GetClusterIndex(int32 CellIndex) const;
+	// Get the min and max cell indices (inclusive) of the input cluster
+	void GetClusterBounds(int32 ClusterIndex, int32& MinX, int32& MinY, int32& MaxX, int32& MaxY) const;
+	// Get the index of the input cell inside the scratch state of a search of the input cluster
+	int32 GetLocalIndex(int32 ClusterIndex, int32 CellIndex) const;
+	// Get the cell index of the input index inside the scratch state of a search of the input cluster
+	int32 GetCellFromLocalIndex(int32 ClusterIndex, int32 LocalIndex) const;
+	// Get the distance between 2 cells with straight moves costing 10 and diagonal moves costing 14 before cell costs are applied, same as the pathfinder
+	int32 GetDistanceBetweenCells(int32 StartCell, int32 EndCell) const;
+
+	// Openings between clusters shorter than this get a single entrance in their middle, longer ones an entrance at each end
+	static constexpr int32 MaxSingleEntranceLength = 6;
+
+	TArray<FCluster> Clusters;								// All clusters of the grid, indexed by ClusterY * NumClustersX + ClusterX
+	int32 ClusterSize = 0;									// Number of cells on each side of a cluster, clusters on the far edges of the grid can be smaller
+	int32 NumClustersX = 0;									// Number of clusters in the X direction
+	int32 NumClustersY = 0;									// Number of clusters in the Y direction
+	int32 GridSizeX = 0;									// Number of cells of the grid in the X direction when the graph was built
+	int32 GridSizeY = 0;									// Number of cells of the grid in the Y direction when the graph was built
+};
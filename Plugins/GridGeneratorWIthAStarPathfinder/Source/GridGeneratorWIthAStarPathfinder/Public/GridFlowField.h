@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeHeap.h"
+
+class AGrid;
+
+// Flow field towards a single goal cell, used to move any number of agents to the same goal
+// Holds the cost of the cheapest path from every cell to the goal (integration field), found by a Dijkstra search backwards from the goal,
+// and for every cell the direction of the neighbor to move to next, so agents sample their next move in O(1) instead of searching
+class GRIDGENERATORWITHASTARPATHFINDER_API FGridFlowField
+{
+public:
+	// Calculate the integration field and directions of all cells towards the input goal cell
+	void Build(const AGrid& InGrid, int32 InGoalCell);
+	// Recalculate the cells whose cost to the goal can be changed by the cells between the input min and max indices (inclusive) changing walkable state or cost
+	// Only the changed cells, the cells whose path to the goal crossed them, and the cells the changes made cheaper are searched again
+	void RepairRegion(FIntPoint MinIndex, FIntPoint MaxIndex);
+	// Get the goal cell of the field
+	int32 GetGoalCell() const;
+	// Get the cost of the cheapest path from the input cell to the goal, MAX_int32 if the goal can't be reached
+	int32 GetCostToGoal(int32 CellIndex) const;
+	// Get the neighbor cell to move to from the input cell, INDEX_NONE at the goal or if the goal can't be reached
+	int32 GetNextCell(int32 CellIndex) const;
+	// Get the unit direction of the move from the input cell to its next cell on the grid plane, zero at the goal or if the goal can't be reached
+	FVector2D GetDirection(int32 CellIndex) const;
+	// Get the number of cells searched by the last Build or RepairRegion
+	int32 GetNumSearched() const;
+
+private:
+	// Search backwards from the cells in the open set, lowering the cost of every cell that can reach the goal cheaper through them
+	// Cells whose cost changed extend the input bounds
+	void SearchIntegration(FIntPoint& ChangedMin, FIntPoint& ChangedMax);
+	// Set the cost of the input cell to the goal and add or move it in the open set
+	void LowerCost(int32 CellIndex, int32 Cost);
+	// Recalculate the directions of the cells between the input min and max indices (inclusive) from the integration field, in parallel tiles
+	void UpdateDirections(FIntPoint MinIndex, FIntPoint MaxIndex);
+
+	// Direction value of cells without a next cell
+	static constexpr uint8 NoDirection = 0xFF;
+	// Number of cells on each side of the tiles whose directions are calculated in parallel
+	static constexpr int32 DirectionTileSize = 64;
+
+	const AGrid* Grid = nullptr;						// Grid the field was built on
+	int32 GoalCell = INDEX_NONE;						// Cell all paths of the field lead to
+	int32 GridSizeX = 0;								// Number of cells of the grid in the X direction when the field was built
+	int32 GridSizeY = 0;								// Number of cells of the grid in the Y direction when the field was built
+	TArray<int32> Costs;								// Cost of the cheapest path from each cell to the goal, MAX_int32 if unreachable
+	TArray<uint8> Directions;							// Neighbor direction of the next cell of each cell, ordered like the Grid neighbor directions, NoDirection if none
+	FNodeHeap OpenNodes;								// Cells whose cost was lowered and whose neighbors weren't updated yet, reused between searches
+	TArray<int32> AffectedCells;						// Cells reset by the last RepairRegion, reused between repairs
+	int32 NumSearched = 0;								// Number of cells searched by the last Build or RepairRegion
+};
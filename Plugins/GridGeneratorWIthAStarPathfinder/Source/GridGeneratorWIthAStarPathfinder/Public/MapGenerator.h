@@ -29,10 +29,16 @@ public:
 	// Blueprint callable function, to generate shortest path on grid between 2 random points
 	UFUNCTION(BlueprintCallable)
 		void PathBetween2RandomPoints();
-	// Function to Randomly spawn obstacles on the grid 
+	// Function to Randomly spawn obstacles on the grid, restarting the random stream from RandomSeed so the same seed always spawns the same obstacles
 	void SpawnObstacles();
 	// Function to create to spawn the GridNodes on the Grid after delay, to ensure all obstacles were already created
 	void CreateGridAfterDelay();
+	// Called on the game thread when the grid finished baking its cells
+	void OnGridCreated();
+	// Find the path between PathStartCell and PathTargetCell on a worker thread, replacing the last query
+	void RequestPath();
+	// Called on the game thread when the asynchronous path query started by RequestPath finished, shows the found path on the grid
+	void OnPathFound(const FPathQueryResult& Result);
 
 public:
 	// Editor changable variable, to set the Grid used in this class
@@ -44,6 +50,9 @@ public:
 	// Editor changable variable, defining the number of spawned nonblocking objects
 	UPROPERTY(EditAnywhere, Category = "Objects Generation")
 		int32 nNonblockingObstacles = 1;
+	// Editor changable variable, seed of the obstacles and random points, 0 picks a new seed every time obstacles are spawned
+	UPROPERTY(EditAnywhere, Category = "Objects Generation")
+		int32 RandomSeed = 0;
 
 private:
 	USceneComponent* DefaultSceneComponent;				// Scene Component to be used root component for this class
@@ -51,4 +60,8 @@ private:
 	UStaticMesh* BlockingObstacleShape;					// Blocking Static mesh model to be spawned by the SpawnObstacles function, to be set as cube that totally blocks path
 	UStaticMesh* NonBlockingObstacleShape;				// Nonblocking Static mesh model to be spawned by the SpawnObstacles function, to be set as wall with open entrance that doesn't block path
 	TArray<AActor*> SpawnedMeshes;						// TArray holding the spawned Static Mesh actors
+	FRandomStream RandomStream;							// Random stream of the spawned obstacles and the random points, seeded by SpawnObstacles
+	FPathQueryHandle PathQueryHandle;					// Handle of the last asynchronous path query, cancelled if a new path is requested before it finishes
+	int32 PathStartCell = INDEX_NONE;					// Start cell of the last requested path
+	int32 PathTargetCell = INDEX_NONE;					// Target cell of the last requested path
 };
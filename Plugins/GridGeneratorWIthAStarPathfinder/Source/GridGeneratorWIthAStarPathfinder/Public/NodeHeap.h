@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Binary min heap of grid cells used as the open set of the A* search
+// Cells are ordered by f_cost, then h_cost, then by the order they entered the heap, which is the same order the old linear scan over the open nodes array used
+// The heap stores the position of each cell in it, so Contains is O(1) and Add, Pop and Update are O(log N)
+class GRIDGENERATORWITHASTARPATHFINDER_API FNodeHeap
+{
+public:
+	// Prepare the heap to hold cells with indices from 0 to NumCells - 1, and remove all cells from it
+	void Initialize(int32 NumCells);
+	// Add a cell that isn't in the heap yet with the input costs
+	void Add(int32 CellIndex, int32 f_cost, int32 h_cost);
+	// Remove and return the cell with the highest priority, returns INDEX_NONE if the heap is empty
+	int32 Pop();
+	// Restore the heap order after the costs of a cell already in the heap were decreased
+	void Update(int32 CellIndex, int32 f_cost, int32 h_cost);
+	// Restore the heap order after the costs of a cell already in the heap were increased or decreased, used by incremental searches
+	void Reprioritize(int32 CellIndex, int32 f_cost, int32 h_cost);
+	// Remove a cell from the heap if it's in it
+	void Remove(int32 CellIndex);
+	// Get the cell with the highest priority without removing it, returns INDEX_NONE if the heap is empty
+	int32 Top() const;
+	// Get the costs of the cell with the highest priority, the heap must not be empty
+	void GetTopCosts(int32& Outf_cost, int32& Outh_cost) const;
+	// Check if the cell is currently in the heap
+	bool Contains(int32 CellIndex) const;
+	// Check if there are no cells left in the heap
+	bool IsEmpty() const;
+	// Get the number of cells in the heap
+	int32 Num() const;
+	// Remove all cells from the heap, keeping the allocated memory to be reused by the next search
+	void Reset();
+
+private:
+	// Entry of the heap array, the costs are copied in the entry so comparing entries doesn't need to read the cost arrays of the search
+	struct FHeapEntry
+	{
+		int32 f_cost;
+		int32 h_cost;
+		uint32 Sequence;									// Order in which the cell entered the heap, used to break f_cost and h_cost ties
+		int32 CellIndex;
+	};
+
+	// Check if entry A should be popped before entry B
+	bool IsHigherPriority(const FHeapEntry& A, const FHeapEntry& B) const;
+	// Move the entry at the input position up until its parent has a higher priority
+	void SiftUp(int32 Index);
+	// Move the entry at the input position down until both its children have a lower priority
+	void SiftDown(int32 Index);
+	// Swap 2 entries in the heap array and update the stored heap positions of their cells
+	void SwapEntries(int32 IndexA, int32 IndexB);
+
+private:
+	TArray<FHeapEntry> HeapEntries;						// TArray holding the entries in binary heap order, the entry with the highest priority is at index 0
+	TArray<int32> HeapIndices;							// Position of each cell in the HeapEntries array, INDEX_NONE if the cell isn't in the heap
+	uint32 NextSequence = 0;							// Sequence number given to the next cell added to the heap
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+
+// Key of a cached path, a path is only reused for the same cells, the same search algorithm and the same Grid version
+// Cell costs are part of the Grid version, so a cost change also invalidates the paths found before it
+struct FPathCacheKey
+{
+	int32 StartCell = INDEX_NONE;
+	int32 TargetCell = INDEX_NONE;
+	uint32 GridVersion = 0;
+	uint8 SearchVariant = 0;							// Search algorithm that found the path, different algorithms can find different paths of the same cost
+
+	bool operator==(const FPathCacheKey& Other) const
+	{
+		return StartCell == Other.StartCell && TargetCell == Other.TargetCell && GridVersion == Other.GridVersion && SearchVariant == Other.SearchVariant;
+	}
+
+	friend uint32 GetTypeHash(const FPathCacheKey& Key)
+	{
+		return HashCombine(HashCombine(::GetTypeHash(Key.StartCell), ::GetTypeHash(Key.TargetCell)), HashCombine(::GetTypeHash(Key.GridVersion), ::GetTypeHash(Key.SearchVariant)));
+	}
+};
+
+// Counters of a path cache, used to size it
+struct FPathCacheStats
+{
+	int64 NumHits = 0;									// Lookups that returned a cached result
+	int64 NumMisses = 0;								// Lookups that found no result
+	int64 NumEvictions = 0;								// Results removed to stay under the memory cap
+	int32 NumEntries = 0;								// Results currently cached
+	int64 MemoryBytes = 0;								// Memory used by the cached results
+};
+
+// Thread safe least recently used cache of path results, shared by all pathfinders searching a Grid
+// Results are cached for the latest Grid version only, seeing a newer version empties the cache, results of older versions are never added
+class GRIDGENERATORWITHASTARPATHFINDER_API FPathCache
+{
+public:
+	FPathCache();
+
+	// Set OutPath to the cached result for the input key and return true if there is one, an empty path means no path exists
+	bool Find(const FPathCacheKey& Key, TArray<int32>& OutPath);
+	// Cache the result of a search for the input key, removing the least recently used results if the memory cap is exceeded
+	void Add(const FPathCacheKey& Key, const TArray<int32>& Path);
+	// Set the max memory used by cached results in bytes, 0 disables the cache
+	void SetMaxMemory(int64 InMaxMemoryBytes);
+	// Remove all cached results, keeping the counters
+	void Empty();
+	// Get the counters of the cache
+	FPathCacheStats GetStats() const;
+
+private:
+	// Empty the cache if the input Grid version is newer than the version of the cached results, returns false if the version is older
+	bool UpdateVersion(uint32 GridVersion);
+	// Remove all cached results, keeping the entry count of the LRU cache, the cache lock must be held
+	void EmptyEntries();
+	// Get the memory used by a cached result
+	static int64 GetEntryMemory(const TArray<int32>& Path);
+
+	mutable FCriticalSection CacheLock;					// Lock guarding all members, lookups and adds come from the game thread and worker threads
+	int32 MaxNumEntries = 1;							// Entry count of the LRU cache, never reached before the memory cap since it's the count of the smallest results fitting in it, declared first since Entries is constructed with it
+	TLruCache<FPathCacheKey, TArray<int32>> Entries;	// Cached paths ordered by their last use
+	uint32 CachedVersion = 0;							// Grid version of all cached results
+	int64 MaxMemoryBytes = 0;							// Max memory used by cached results
+	FPathCacheStats Stats;								// Counters of the cache, NumEntries and MemoryBytes are kept up to date
+};
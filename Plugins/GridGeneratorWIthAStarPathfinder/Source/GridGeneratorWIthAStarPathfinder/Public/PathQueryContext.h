@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NodeHeap.h"
+
+// State of a search after being advanced by UPathfinder::StepSearch
+enum class EPathSearchStatus : uint8
+{
+	InProgress,											// Search can be advanced further
+	PathFound,											// Target cell was reached
+	NoPath,												// Open set is empty without reaching the target cell, or the grid was recreated during the search
+	Cancelled											// Search was stopped by its cancel flag
+};
+
+// Scratch memory of a single query, arrays and heaps taken from it keep their memory when the arena is reset, so queries after the first don't allocate
+class GRIDGENERATORWITHASTARPATHFINDER_API FPathQueryArena
+{
+public:
+	// Take the next free scratch array, emptied but keeping its memory, valid until the arena is reset
+	TArray<int32>& AllocateArray();
+	// Take the next free scratch heap, emptied but keeping its memory, valid until the arena is reset
+	FNodeHeap& AllocateHeap();
+	// Return all arrays and heaps taken since the last reset to the arena
+	void Reset();
+	// Get the number of times the arena had to allocate new memory, stays constant once it warmed up to the queries using it
+	int32 GetNumAllocations() const;
+
+private:
+	TArray<TUniquePtr<TArray<int32>>> Arrays;			// Scratch arrays, held by pointer so references stay valid when more are added
+	TArray<int32> ArrayCapacities;						// Capacity of each scratch array when it was taken, used to count the arrays that grew
+	TArray<TUniquePtr<FNodeHeap>> Heaps;				// Scratch heaps, held by pointer so references stay valid when more are added
+	int32 NumUsedArrays = 0;							// Number of scratch arrays taken since the last reset
+	int32 NumUsedHeaps = 0;								// Number of scratch heaps taken since the last reset
+	int32 NumAllocations = 0;							// Number of scratch arrays and heaps created, and scratch arrays grown
+};
+
+// Search state of a single path query: costs and parent of every cell, the open set and an arena of scratch memory
+// Records of the cells are stamped with the generation of the query that wrote them, so starting a new query doesn't need to clear them
+class GRIDGENERATORWITHASTARPATHFINDER_API FPathQueryContext
+{
+public:
+	// Start a new query between the input cells on a grid with the input number of cells, invalidating the records of the last query
+	void BeginQuery(int32 NumCells, int32 InStartCell, int32 InTargetCell);
+	// Get the start cell of the current query
+	int32 GetStartCell() const;
+	// Get the target cell of the current query
+	int32 GetTargetCell() const;
+	// Get the number of cells of the grid the current query runs on
+	int32 GetNumCells() const;
+	// Get the number of cells analyzed by the current query so far, including the cells analyzed by the backward half of a bidirectional search
+	int32 GetNumAnalyzed() const;
+	// Get the number of cells analyzed by the backward half of the current query if it's a bidirectional search, 0 otherwise
+	int32 GetNumAnalyzedBackward() const;
+	// Count the analyzed cells, walkability lookups, open set and allocations of the backward half of a bidirectional search, which runs in the input context, as part of the current query
+	void AddBackwardQuery(const FPathQueryContext& Backward);
+	// Get the number of walkable state checks of the cells the current query could move to, the neighbors of expanded cells and the diagonal steps of jump point search
+	int32 GetNumWalkabilityLookups() const;
+	// Count walkable state checks made by the current query
+	void AddWalkabilityLookups(int32 Num);
+	// Get the largest number of cells in the open set of the current query so far
+	int32 GetPeakOpenNodes() const;
+	// Raise the peak open set size of the current query to the input size if it's larger
+	void UpdatePeakOpenNodes(int32 NumOpenNodes);
+	// Get the number of times the context had to allocate memory since the current query began
+	int32 GetNumQueryAllocations() const;
+	// Check if the cell was reached by the current query, only then its costs and parent are valid
+	bool IsVisited(int32 CellIndex) const;
+	// Check if the cell was analyzed by the current query
+	bool IsAnalyzed(int32 CellIndex) const;
+	// Mark the cell as analyzed by the current query
+	void SetAnalyzed(int32 CellIndex);
+	// Set the costs and parent of the cell for the current query, marking it as visited
+	void Visit(int32 CellIndex, int32 g_cost, int32 h_cost, int32 ParentCell);
+	// Getters for the record of a visited cell
+	int32 Getg_cost(int32 CellIndex) const;
+	int32 Geth_cost(int32 CellIndex) const;
+	int32 Getf_cost(int32 CellIndex) const;
+	int32 GetParentCell(int32 CellIndex) const;
+	// Get the open set of the current query
+	FNodeHeap& GetOpenNodes();
+	// Get the scratch memory of the query, reset by whoever runs the query before taking from it
+	FPathQueryArena& GetArena();
+	// Get the number of times the context had to allocate memory for its records or arena, stays constant under sustained load on the same grid
+	int32 GetNumAllocations() const;
+
+private:
+	// Search state of a single cell, only valid if VisitedGeneration equals the generation of the current query
+	struct FCellRecord
+	{
+		int32 g_cost;
+		int32 h_cost;
+		int32 ParentCell;
+		uint32 VisitedGeneration;
+		uint32 AnalyzedGeneration;
+	};
+
+	TArray<FCellRecord> Records;						// Record of every cell of the grid, indexed by cell index
+	uint32 Generation = 0;								// Generation of the current query, incremented by BeginQuery
+	int32 StartCell = INDEX_NONE;						// Start cell of the current query
+	int32 TargetCell = INDEX_NONE;						// Target cell of the current query
+	int32 NumAnalyzed = 0;								// Number of cells analyzed by the current query, used to compare search modes
+	int32 NumAnalyzedBackward = 0;						// Number of cells of NumAnalyzed analyzed by the backward half of a bidirectional search
+	int32 NumWalkabilityLookups = 0;					// Number of walkable state checks made by the current query
+	int32 PeakOpenNodes = 0;							// Largest open set of the current query, the sum of both open sets for a bidirectional search
+	int32 QueryStartAllocations = 0;					// Number of allocations of the context when the current query began
+	int32 NumBackwardAllocations = 0;					// Number of allocations made by the backward half of a bidirectional search
+	int32 NumRecordAllocations = 0;						// Number of times the records and open set were allocated for a new grid size
+	FNodeHeap OpenNodes;								// Binary heap of the cells to be analyzed by the current query
+	FPathQueryArena Arena;								// Scratch memory reused by the queries run with this context
+};
+
+// Thread safe pool of query contexts, so searches can reuse the memory of finished ones instead of allocating state for the whole grid every query
+class GRIDGENERATORWITHASTARPATHFINDER_API FPathQueryContextPool
+{
+public:
+	// Take a free context from the pool, or create a new one if all contexts are in use
+	TUniquePtr<FPathQueryContext> Acquire();
+	// Return a context to the pool after its query finished
+	void Release(TUniquePtr<FPathQueryContext> Context);
+	// Free all contexts not in use, called when the grid is recreated with a different number of cells
+	void Empty();
+
+private:
+	FCriticalSection PoolLock;							// Lock guarding FreeContexts, contexts are acquired and released from any thread
+	TArray<TUniquePtr<FPathQueryContext>> FreeContexts;	// Contexts that aren't used by any query
+};
+
+// Acquire a context from the input pool for the lifetime of this object
+class GRIDGENERATORWITHASTARPATHFINDER_API FScopedPathQueryContext
+{
+public:
+	explicit FScopedPathQueryContext(FPathQueryContextPool& InPool);
+	~FScopedPathQueryContext();
+
+	FPathQueryContext& Get() const;
+
+private:
+	FPathQueryContextPool& Pool;
+	TUniquePtr<FPathQueryContext> Context;
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Pathfinder.h"
+#include "PathRequestScheduler.generated.h"
+
+// Statistics of the path requests handled by a scheduler, used to size its frame budget
+struct FPathSchedulerStats
+{
+	int32 NumRequested = 0;								// Number of paths requested
+	int32 NumDeduplicated = 0;							// Number of requests merged into an identical request already in the queue
+	int32 NumCompleted = 0;								// Number of requests whose search finished
+	double TotalWaitTimeMs = 0.0;						// Sum of the wait times of all completed requests
+	double MaxWaitTimeMs = 0.0;							// Longest wait time of a completed request
+	double LastFrameTimeUs = 0.0;						// Time spent running searches in the last tick in microseconds
+};
+
+// Actor component queuing path requests of many agents and running their searches on the game thread within a time budget per frame
+// Requests for the same start and target cells are merged, requests with higher priority are searched first, and searches not finished when the budget runs out continue next frame
+// Uses the Pathfinder component of the same actor to run the searches
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class GRIDGENERATORWITHASTARPATHFINDER_API UPathRequestScheduler : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UPathRequestScheduler();
+
+protected:
+	// Called when the game starts, finds the Pathfinder component of the owner
+	virtual void BeginPlay() override;
+	// Called when the game ends, drops all queued requests
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called every frame, runs the queued searches until the frame budget is spent
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Queue a path request between 2 given locations, OnComplete is executed on the game thread when its search finishes
+	FPathQueryHandle RequestPath(FVector StartPos, FVector TargetPos, int32 Priority, FOnPathQueryComplete OnComplete);
+	// Queue a path request between 2 given cells, OnComplete is executed on the game thread when its search finishes
+	FPathQueryHandle RequestPathCell(int32 StartCell, int32 TargetCell, int32 Priority, FOnPathQueryComplete OnComplete);
+	// Remove a queued request, its OnComplete delegate won't be executed
+	void CancelRequest(FPathQueryHandle Handle);
+	// Get the number of queued searches, identical requests share a single search
+	UFUNCTION(BlueprintCallable)
+		int32 GetQueueDepth() const;
+	// Get the average time between requesting a path and receiving its result in milliseconds
+	UFUNCTION(BlueprintCallable)
+		double GetAverageWaitTimeMs() const;
+	// Get the statistics of all requests handled by this scheduler
+	const FPathSchedulerStats& GetStats() const;
+
+private:
+	// Caller waiting for the result of a queued search
+	struct FPathRequester
+	{
+		uint32 QueryId;
+		FOnPathQueryComplete OnComplete;
+		double RequestTime;								// Time in seconds the path was requested
+	};
+	// Search shared by all requests with the same start and target cells
+	struct FScheduledPathSearch
+	{
+		int32 StartCell;
+		int32 TargetCell;
+		int32 Priority;									// Highest priority of all requesters
+		double EnqueueTime;								// Time in seconds the first requester queued the search, orders searches with the same priority
+		double SearchTimeMs = 0.0;						// Time spent advancing the search over all frames
+		uint32 GridVersion = 0;							// Version of the Grid walkable state when the search started, cells changed after it flag the result for repath
+		TUniquePtr<FPathQueryContext> Context;			// Search context taken from the Grid pool once the search starts, nullptr while it's waiting
+		TArray<FPathRequester> Requesters;
+	};
+
+	// Deliver the result of a finished search to all its requesters, and return its context to the Grid pool
+	void CompleteSearch(FScheduledPathSearch& Search, EPathSearchStatus Status, TArray<int32>&& Path);
+	// Get the key of the search between the input cells in the SearchesByCells map
+	static uint64 GetCellsKey(int32 StartCell, int32 TargetCell);
+
+public:
+	// Time in microseconds the scheduler may spend running searches each frame
+	UPROPERTY(EditAnywhere, Category = "Scheduling")
+		float FrameBudgetMicroseconds = 1000.0f;
+	// Number of cells analyzed between checks of the frame budget
+	UPROPERTY(EditAnywhere, Category = "Scheduling")
+		int32 IterationsPerStep = 64;
+
+private:
+	UPathfinder* Pathfinder;							// Pathfinder component of the owner used to run the searches
+	TArray<TUniquePtr<FScheduledPathSearch>> Searches;	// Queued searches, sorted by priority at the start of every tick
+	TMap<uint64, FScheduledPathSearch*> SearchesByCells;	// Queued searches by start and target cells, used to merge identical requests
+	TMap<uint32, FScheduledPathSearch*> SearchesByQueryId;	// Queued searches by the query id of each of their requesters, used to cancel requests
+	uint32 NextQueryId = 1;								// Id given to the next request, 0 is never used so it marks invalid handles
+	FPathSchedulerStats Stats;							// Statistics of all requests handled by this scheduler
+};
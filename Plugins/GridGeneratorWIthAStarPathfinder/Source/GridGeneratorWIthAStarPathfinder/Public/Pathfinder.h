@@ -5,8 +5,49 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Grid.h"
+#include "PathQueryContext.h"
+#include "DStarLitePlanner.h"
+#include "Tasks/Task.h"
+#include <atomic>
 #include "Pathfinder.generated.h"
 
+// Algorithm used by the pathfinder to search the Grid, A* and jump point search find paths of the same cost
+UENUM()
+enum class EPathSearchMode : uint8
+{
+	AStar UMETA(DisplayName = "A*"),						// Analyzes every cell reached by the search
+	JumpPointSearch UMETA(DisplayName = "Jump Point Search"),	// Jumps along straight and diagonal lines of the uniform cost Grid, only analyzing cells where the path may turn
+	ThetaStar UMETA(DisplayName = "Theta* (any-angle)")		// A* that links each cell to the parent of its neighbor when there's a line of sight, finding shorter paths at any angle instead of 45 degree steps
+};
+
+// Result of an asynchronous path query, passed to the completion delegate on the game thread
+struct FPathQueryResult
+{
+	int32 StartCell = INDEX_NONE;
+	int32 TargetCell = INDEX_NONE;
+	bool bPathFound = false;
+	TArray<int32> Path;									// Cells of the found path ordered from start cell to target cell, empty if no path found
+	TArray<int32> Waypoints;							// Cells of the path where it turns, including start and target cells, only set if the pathfinder has bSmoothPath set
+	double SearchTimeMs = 0.0;							// Time spent running the search in milliseconds
+	int32 NumAnalyzedCells = 0;							// Number of cells analyzed by the search
+	uint32 GridVersion = 0;								// Version of the Grid walkable state when the search started
+	bool bNeedsRepath = false;							// Set if cells of the path, or any cell if no path was found, changed walkable state after the search started
+	double WaitTimeMs = 0.0;							// Time between requesting the path and delivering the result in milliseconds
+};
+
+// Delegate executed on the game thread when an asynchronous path query finishes
+DECLARE_DELEGATE_OneParam(FOnPathQueryComplete, const FPathQueryResult&);
+
+// Delegate broadcast when cells of the current path of a pathfinder changed walkable state
+DECLARE_MULTICAST_DELEGATE(FOnPathInvalidated);
+
+// Handle of an asynchronous path query, used to cancel it or check if it's still running
+struct FPathQueryHandle
+{
+	uint32 QueryId = 0;
+
+	bool IsValid() const { return QueryId != 0; }
+};
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GRIDGENERATORWITHASTARPATHFINDER_API UPathfinder : public UActorComponent
@@ -21,18 +62,160 @@ public:
 	void FindPath(FVector StartPos, FVector TargetPos);
 	// Find shortest path between 2 gived GridNodes
 	void FindPathNode(AGridNode* StartNode, AGridNode* TargetNode);
+	// Find shortest path between 2 given cells of the Grid, returns true if a path was found
+	bool FindPathCell(int32 StartCell, int32 TargetCell);
+	// Find shortest path between 2 given cells with the incremental planner, which keeps its search tree between calls with the same target cell
+	// Calls after the start moved along the path or Grid regions were rebaked only repair the affected part of the tree, returns true if a path was found
+	bool FindPathCellIncremental(int32 StartCell, int32 TargetCell);
+	// Find shortest path between 2 given locations on a worker thread, OnComplete is executed on the game thread when the search finishes
+	FPathQueryHandle FindPathAsync(FVector StartPos, FVector TargetPos, FOnPathQueryComplete OnComplete);
+	// Find shortest path between 2 given cells on a worker thread, OnComplete is executed on the game thread when the search finishes
+	FPathQueryHandle FindPathCellAsync(int32 StartCell, int32 TargetCell, FOnPathQueryComplete OnComplete);
+	// Stop an asynchronous path query, its OnComplete delegate won't be executed
+	void CancelPathQuery(FPathQueryHandle Handle);
+	// Stop all asynchronous path queries started by this pathfinder
+	void CancelAllPathQueries();
+	// Check if an asynchronous path query is still running and wasn't cancelled
+	bool IsPathQueryPending(FPathQueryHandle Handle) const;
+	// Get the number of asynchronous path queries still running
+	int32 GetNumPendingPathQueries() const;
 	// Get the distance between nodes on the Grid
 	int32 GetDistanceBetweenNodes(const AGridNode* StartNode, const AGridNode* EndNode);
-	// Return TArray of GridNodes containing the path from Start Node to Target Node
-	TArray<AGridNode*> RetracePath(const AGridNode* StartNode, AGridNode* EndNode);
+	// Get the distance between cells on the Grid
+	int32 GetDistanceBetweenCells(int32 StartCell, int32 EndCell) const;
+	// Set OutDistances[i] to the distance between Cells[i] and the target cell, evaluating the cells in vectorized batches, used to score many candidate cells at once
+	void GetDistancesToCell(TArrayView<const int32> Cells, int32 TargetCell, TArrayView<int32> OutDistances) const;
+	// Run the search between 2 given cells using the input search context, only reads the Grid so it can run for many queries at once, returns true if a path was found
+	// Long queries use the Grid cluster graph if bUseHierarchicalSearch is set, falling back to a full search if the cluster graph finds no route
+	// The full search runs from both ends if bUseBidirectionalSearch is set and the Grid is searched with A*
+	// If bUsePathCache is set, the result is taken from the Grid path cache when the same query was searched on the current Grid version, else it's added to it
+	// The search stops without a path as soon as the optional cancel flag is set
+	bool SearchPath(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled = nullptr) const;
+	// Get the path cache key of a query between the input cells on the input Grid version, bHierarchical is set for queries run by SearchPath and not set for queries advanced by StepSearch
+	// Queries advanced by StepSearch never use the cluster graph or the bidirectional search, reads the Grid cells so worker threads must hold the cell data lock for reading
+	FPathCacheKey GetPathCacheKey(int32 StartCell, int32 TargetCell, uint32 GridVersion, bool bHierarchical) const;
+	// Start a search between 2 given cells in the input search context, without analyzing any cell yet
+	void BeginSearch(FPathQueryContext& Context, int32 StartCell, int32 TargetCell) const;
+	// Advance the search started in the input context by analyzing at most MaxIterations cells with the algorithm set by SearchMode, OutPath is set once the search returns PathFound
+	// Searches can be advanced a few iterations at a time across frames, since all their state is kept in the context
+	EPathSearchStatus StepSearch(FPathQueryContext& Context, int32 MaxIterations, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled = nullptr) const;
+	// Fill OutWaypoints with the cells of the input path where a straight line can't reach further, by string pulling with line of sight checks on the Grid walkability bitmap
+	// Lines only cross cells no costlier than the cells of the path they replace, so smoothing doesn't cut through expensive terrain, safe to call from worker threads
+	void SmoothPath(const TArray<int32>& Path, TArray<int32>& OutWaypoints) const;
+	// Fill OutPath with the cell indices of the path from Start cell to End cell found by the search using the input context, including the cells between jump points and any-angle parents
+	// OutPath is emptied but keeps its memory, so callers reusing the same array don't allocate
+	void RetracePath(const FPathQueryContext& Context, int32 StartCell, int32 EndCell, TArray<int32>& OutPath) const;
 	// Reset the color and walkable state of the last calculated path
 	void ResetLastPath();
+	// Get the cells of the last calculated path, ordered from start cell to target cell
+	const TArray<int32>& GetCurrentPath() const;
+	// Set the input path as the current path and highlight its cells on the Grid, resetting the last path
+	void ShowPath(const TArray<int32>& Path);
+	// Check if the input path found on the input Grid version should be searched again, because its cells changed walkable state, or any cell changed if the path is empty
+	bool IsPathOutdated(const TArray<int32>& Path, uint32 GridVersion) const;
+	// Check if cells of the current path changed walkable state since it was found
+	bool DoesCurrentPathNeedRepath() const;
+
+protected:
+	// Called when the game starts, listens to walkable state changes of the Grid
+	virtual void BeginPlay() override;
+	// Called when the game ends or the component is destroyed, cancels all asynchronous queries and waits for their worker tasks
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	// Called when cells of the Grid changed walkable state, passes them to the incremental planner and flags the current path for repath if it crosses them
+	void OnGridRegionChanged(FIntPoint MinIndex, FIntPoint MaxIndex);
+	// Same as BeginSearch, the Grid cell data lock must be held for reading
+	void BeginSearchLocked(FPathQueryContext& Context, int32 StartCell, int32 TargetCell) const;
+	// Same as StepSearch, the Grid cell data lock must be held for reading
+	EPathSearchStatus StepSearchLocked(FPathQueryContext& Context, int32 MaxIterations, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const;
+	// Check if the input cells are at least HierarchicalMinDistance cells apart along X or Y, so a query between them uses the cluster graph
+	bool IsHierarchicalQuery(int32 StartCell, int32 TargetCell) const;
+	// Run the search of SearchPath without the path cache, the Grid cell data lock must be held for reading
+	bool SearchPathUncached(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const;
+	// Run A* from the start cell towards the target cell in the input context and from the target cell towards the start cell in a second context from the Grid pool
+	// Each iteration expands the side with the smaller open set, and the search stops once the cheapest path through a cell reached by both sides can't be improved
+	// Cells analyzed by the backward side are counted in the input context, the Grid cell data lock must be held for reading
+	bool SearchPathBidirectional(FPathQueryContext& Context, int32 StartCell, int32 TargetCell, TArray<int32>& OutPath, const std::atomic<bool>* bCancelled) const;
+	// Called when the Grid was created again, discards the search tree of the incremental planner
+	void OnGridCreated();
+	// Check if both input cells are inside the cells of the Grid, used to reject queries before searching
+	bool AreCellsInGrid(int32 StartCell, int32 TargetCell) const;
+	// Called on the game thread when the worker task of an asynchronous query finished
+	void CompletePathQuery(uint32 QueryId, FPathQueryResult&& Result);
+	// Change the color of the start cell of the current path to green, target cell to yellow and all other path cells to black
+	void HighlightCurrentPath();
+	// Add the walkable neighbor cells of the input cell to the open set of the search, used by A*
+	void AddNeighborCells(FPathQueryContext& Context, int32 CurrentCell) const;
+	// Add the walkable neighbor cells of the input cell to the open set of the search, linking them to the parent of the input cell when it's in line of sight, used by Theta*
+	void AddNeighborCellsAnyAngle(FPathQueryContext& Context, int32 CurrentCell) const;
+	// Get the straight line distance between the centers of 2 cells, rounded down in the units of GetDistanceBetweenCells so straight and diagonal lines match it
+	int32 GetAnyAngleDistance(int32 StartCell, int32 EndCell) const;
+	// Add the jump points reached from the input cell in the directions not pruned by its parent to the open set of the search, used by jump point search
+	void AddJumpPoints(FPathQueryContext& Context, int32 CurrentCell) const;
+	// Move from the input cell in a straight direction using the Grid jump distances, returns the jump point or target cell reached, or INDEX_NONE if the move is blocked first
+	int32 JumpStraight(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY, int32 TargetCell) const;
+	// Move from the input cell in a diagonal direction, returns the first cell that is the target, has a forced neighbor or has a straight jump point, or INDEX_NONE if the move is blocked first
+	// Adds the number of cells whose walkable state was checked to NumLookups
+	int32 JumpDiagonal(int32 IndexX, int32 IndexY, int32 DirX, int32 DirY, int32 TargetCell, int32& NumLookups) const;
+	// Set the input cell as reached from FromCell if it's not in the open set or the new g_cost is smaller, and add or move it in the open set
+	void VisitCell(FPathQueryContext& Context, int32 FromCell, int32 Cell) const;
+	// Same as VisitCell, with the move cost from FromCell and the h_cost of the cell already calculated
+	void VisitCell(FPathQueryContext& Context, int32 FromCell, int32 Cell, int32 MoveCost, int32 h_cost) const;
 
 public:
 	// Pointer to Grid class this pathfinder class uses to draw the path
 	UPROPERTY(EditAnywhere, Category = "Grid Reference")
 		AGrid* Grid;
 
+	FOnPathInvalidated OnCurrentPathInvalidated;	// Broadcast when cells of the current path changed walkable state, listeners should search the path again
+
+	// Algorithm used to search the Grid, jump point search analyzes far fewer cells on open maps, grids whose cells have different costs or that stream tiles are searched with A* instead of jump point search
+	// Theta* paths are shorter but not always the shortest, its shortcuts only cross the cheapest cells of the Grid
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		EPathSearchMode SearchMode = EPathSearchMode::AStar;
+
+	// Set the waypoints of asynchronous and scheduled query results, computed on the thread that ran the search
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		bool bSmoothPath = false;
+
+	// Use the Grid cluster graph for queries between cells at least HierarchicalMinDistance cells apart, if the Grid built it
+	// Hierarchical paths are near optimal, queries advanced by StepSearch always use SearchMode
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		bool bUseHierarchicalSearch = false;
+
+	// Min distance in cells along X or Y between start and target cells for a query to use the cluster graph
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		int32 HierarchicalMinDistance = 64;
+
+	// Search from the start and target cells at once and join the searches where they meet, paths have the same cost as A* while analyzing fewer cells on long open routes
+	// Only used when the Grid is searched with A* and not Theta*, queries advanced by StepSearch always search from the start cell only
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		bool bUseBidirectionalSearch = false;
+
+	// Reuse the results of queries between the same cells on the same Grid version from the Grid path cache, useful when many agents request the same routes
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		bool bUsePathCache = false;
+
+	// Request the Grid tiles that aren't resident under found paths, so their unknown cells are baked and the path is flagged for repath if they turn out different
+	// Only used if the Grid streams tiles, paths are still found across unknown cells using the Grid UnknownCellCost
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+		bool bRequestMissingTiles = false;
+
 private:
-	TArray<AGridNode*> CurrentPath;			 // TArray of GridNodes containing the path from Start Node to Target Node for the current calculations
+	TArray<int32> CurrentPath;				 // TArray of cell indices containing the path from Start cell to Target cell for the current calculations
+	bool bCurrentPathNeedsRepath = false;	 // Set when cells of the current path changed walkable state
+	AGrid* BoundGrid = nullptr;				 // Grid whose region changes this pathfinder listens to
+	FDStarLitePlanner IncrementalPlanner;	 // D* Lite planner used by FindPathCellIncremental, keeps its search tree between calls
+
+	// State of an asynchronous path query started by this pathfinder
+	struct FPendingPathQuery
+	{
+		UE::Tasks::FTask Task;												// Worker task running the search
+		TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> bCancelled;		// Flag read by the search to stop early
+		FOnPathQueryComplete OnComplete;									// Delegate executed with the result on the game thread
+		double RequestTime;													// Time in seconds the query was requested, used to report its wait time
+	};
+	TMap<uint32, FPendingPathQuery> PendingQueries;	// Asynchronous queries whose result wasn't delivered yet, by query id
+	uint32 NextQueryId = 1;					 // Id given to the next asynchronous query, 0 is never used so it marks invalid handles
 };
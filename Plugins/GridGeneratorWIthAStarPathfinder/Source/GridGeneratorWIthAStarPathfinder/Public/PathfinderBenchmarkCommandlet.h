@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Pathfinder.h"
+#include "PathfinderBenchmarkCommandlet.generated.h"
+
+// Headless benchmark of the pathfinder on reproducible maps, runs without rendering so it can track regressions on build machines
+// For every grid size and obstacle density a world is created, obstacles are spawned by AMapGenerator::SpawnObstacles from the seed, and the grid is baked
+// Then a fixed set of queries between seeded random walkable cells is searched with every search mode, and the latency percentiles, analyzed cells, allocations and memory are reported
+// Usage: UnrealEditor-Cmd <Project> -run=PathfinderBenchmark -nullrhi [-Sizes=64,128,256] [-Densities=0,2,5] [-Queries=1000] [-Seed=1] [-Output=<csv path>]
+// Densities are blocking obstacles per 1000 cells, the results are logged and written to Saved/Benchmarks/PathfinderBenchmark.csv unless Output is set
+UCLASS()
+class GRIDGENERATORWITHASTARPATHFINDER_API UPathfinderBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPathfinderBenchmarkCommandlet();
+
+	// Run the benchmark with the input command line parameters, returns 0 on success
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	// Search mode configuration benchmarked on every map
+	struct FBenchmarkMode
+	{
+		const TCHAR* Name;
+		EPathSearchMode SearchMode;
+		bool bBidirectional;
+	};
+
+	// Create a world with a floor, a grid of the input size, and the obstacles of the input density spawned from the input seed, then bake the grid
+	// Returns the baked grid, or nullptr if the world couldn't be set up
+	AGrid* CreateBenchmarkMap(int32 GridSize, int32 Density, int32 Seed, UWorld*& OutWorld) const;
+	// Destroy a world created by CreateBenchmarkMap
+	void DestroyBenchmarkMap(UWorld* World) const;
+	// Pick the input number of start and target cell pairs among the walkable cells of the grid from the input seed
+	static void CreateQuerySet(const AGrid& Grid, int32 NumQueries, int32 Seed, TArray<TPair<int32, int32>>& OutQueries);
+	// Search all queries of the set with the input mode, and append the CSV row of the results to the report
+	void RunQuerySet(AGrid& Grid, const FBenchmarkMode& Mode, const TArray<TPair<int32, int32>>& Queries, const FString& MapLabel, FString& Report) const;
+	// Get the value at the input percentile (0 to 100) of the input sorted array
+	template <typename ValueType>
+	static ValueType GetPercentile(const TArray<ValueType>& SortedValues, int32 Percentile)
+	{
+		return SortedValues.IsEmpty() ? ValueType(0) : SortedValues[(SortedValues.Num() - 1) * Percentile / 100];
+	}
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include <atomic>
+
+class FPathQueryContext;
+
+// Set to 1 to also time the neighbor expansion and heuristic of every analyzed cell, they run millions of times per second so their scopes are compiled out by default
+#ifndef PATHFINDING_DETAILED_STATS
+#define PATHFINDING_DETAILED_STATS 0
+#endif
+
+DECLARE_STATS_GROUP(TEXT("Pathfinding"), STATGROUP_Pathfinding, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_PathfindingSearch, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search Step"), STAT_PathfindingSearchStep, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Neighbor Expansion"), STAT_PathfindingNeighborExpansion, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Heuristic"), STAT_PathfindingHeuristic, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Retrace"), STAT_PathfindingRetrace, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Smooth Path"), STAT_PathfindingSmoothPath, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid Bake"), STAT_PathfindingGridBake, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid Publish"), STAT_PathfindingGridPublish, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid Rebake Region"), STAT_PathfindingRebakeRegion, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grid Tile Bake"), STAT_PathfindingTileBake, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flow Field"), STAT_PathfindingFlowField, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queries"), STAT_PathfindingQueries, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_PathfindingNodesExpanded, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Walkability Lookups"), STAT_PathfindingWalkabilityLookups, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Allocations"), STAT_PathfindingAllocations, STATGROUP_Pathfinding, GRIDGENERATORWITHASTARPATHFINDER_API);
+
+// Time the enclosing scope in the Pathfinding stat group (stat Pathfinding) and as a named CPU scope in Unreal Insights traces
+#define PATHFINDING_SCOPE(Stat) SCOPE_CYCLE_COUNTER(Stat); TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+
+// Same as PATHFINDING_SCOPE for the scopes entered for every analyzed cell, only compiled if PATHFINDING_DETAILED_STATS is set
+#if PATHFINDING_DETAILED_STATS
+#define PATHFINDING_DETAILED_SCOPE(Stat) PATHFINDING_SCOPE(Stat)
+#else
+#define PATHFINDING_DETAILED_SCOPE(Stat)
+#endif
+
+// Counters of all path queries since the last reset, updated from any thread without locks
+// Each finished query adds its counters to the per frame stats of the Pathfinding group, to the Insights counters, and to a latency histogram with power of 2 buckets
+// Pathfinding.DumpStats logs the totals and latency percentiles, Pathfinding.ResetStats starts over, so soak tests can sample them between phases
+class GRIDGENERATORWITHASTARPATHFINDER_API FPathfindingStats
+{
+public:
+	// Number of latency buckets, bucket 0 counts queries under 1 microsecond, bucket N queries from 2^(N-1) up to 2^N microseconds, the last bucket all slower queries
+	static constexpr int32 NumLatencyBuckets = 24;
+
+	// Add the counters of the query run in the input context, which took the input time in milliseconds
+	static void RecordQuery(const FPathQueryContext& Context, double SearchTimeMs, bool bPathFound);
+	// Get the number of queries recorded since the last reset
+	static uint64 GetNumQueries();
+	// Get the upper bound in milliseconds of the latency bucket containing the input percentile (0 to 100) of the recorded queries, 0 if none were recorded
+	static double GetLatencyPercentileMs(int32 Percentile);
+	// Log the totals and the latency histogram of the recorded queries
+	static void Dump();
+	// Clear all recorded counters
+	static void Reset();
+
+private:
+	// Get the latency bucket of a query taking the input time in milliseconds
+	static int32 GetLatencyBucket(double SearchTimeMs);
+
+	static std::atomic<uint64> NumQueries;
+	static std::atomic<uint64> NumPathsFound;
+	static std::atomic<uint64> NodesExpanded;
+	static std::atomic<uint64> WalkabilityLookups;
+	static std::atomic<uint64> Allocations;
+	static std::atomic<uint32> PeakOpenNodes;			// Largest open set of any recorded query
+	static std::atomic<uint32> LatencyBuckets[NumLatencyBuckets];
+};